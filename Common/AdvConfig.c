@@ -0,0 +1,116 @@
+/* ========================================
+ * Air Quality Beacon, part of the hackAIR project.
+ * Freely available under CC BY 4.0
+ *
+ * http://www.hackair.eu/
+*/
+#include "AdvConfig.h"
+#include "AdvFrame.h"
+#include "SipHash.h"
+
+#define AD_TYPE_NAME        (0x09u)     // Complete local name
+#define NAME_OFFSET         (3u)        // After the flags, kept from the BLE component
+#define SERIAL_LEN          (5u)        // "-" and 4 hex digits
+
+extern CYBLE_GAPP_DISC_MODE_INFO_T cyBle_discoveryModeInfo;
+
+static const char defaultName[] = "Air Beacon";
+static const char hexDigits[] = "0123456789ABCDEF";
+static uint8 applied[ADVCONFIG_BLOCK_LEN]; // Block the advertising data was built from
+static uint8 key[SIPHASH_KEY_LEN];      // Frame tag key as applied
+static uint8 built;
+static uint8 prefix[ADVFRAME_OFFSET];   // Flags and name as built, for AdvConfig_Restore()
+static uint8 prefixLen;
+
+/*******************************************************************
+* NAME :            uint8 AdvConfig_Update()
+*
+* DESCRIPTION :     Build the name and the frame position from the
+*                   configuration block, when it differs from the
+*                   one last applied. A frame already in the
+*                   advertising data moves along, at boot the
+*                   advertisement holds the name only until the
+*                   first frame. Call at boot and whenever the block
+*                   may have been rewritten.
+* OUTPUTS :
+*       uint8 1 if the advertising data was rebuilt
+*/
+uint8 AdvConfig_Update(void){
+    reg8 *cfg = ADVCONFIG_BLOCK;
+    uint8 *adv = cyBle_discoveryModeInfo.advData->advData;
+    uint8 frameBytes[ADVFRAME_LEN];
+    uint8 hasFrame = (built && (cyBle_discoveryModeInfo.advData->advDataLen >= (AdvFrame_Offset() + ADVFRAME_LEN)) &&
+                      (adv[AdvFrame_Offset() + 1u] == ADVFRAME_AD_TYPE)) ? 1u : 0u; // Not while an Eddystone page is out
+    uint8 changed = 0u;
+    uint8 valid = ((cfg[0] == 'h') && (cfg[1] == 'A') && (cfg[3] <= ADVCONFIG_NAME_MAX)) ? 1u : 0u;
+    uint8 options = valid ? cfg[2] : 0u;
+    uint16 company = valid ? (uint16)(cfg[4] | ((uint16)cfg[5] << 8)) : ADVFRAME_COMPANY_ID;
+    uint8 tagged = ((options & ADVCONFIG_OPT_TAG) != 0u) ? 1u : 0u;
+    uint8 i;
+    uint8 n;
+    
+    for(i = 0u; i < ADVCONFIG_BLOCK_LEN; i++){
+        if(applied[i] != cfg[i]) changed = 1u;
+        applied[i] = cfg[i];
+    }
+    for(i = 0u; i < SIPHASH_KEY_LEN; i++){
+        if(key[i] != ADVCONFIG_KEY[i]) changed = 1u;
+        key[i] = ADVCONFIG_KEY[i];
+    }
+    if(built && !changed) return 0u;
+    built = 1u;
+    
+    for(i = 0u; i < ADVFRAME_LEN; i++) frameBytes[i] = adv[AdvFrame_Offset() + i];
+    
+    i = NAME_OFFSET;
+    if((options & ADVCONFIG_OPT_NO_NAME) == 0u){
+        uint8 len = valid ? cfg[3] : (uint8)(sizeof(defaultName) - 1u);
+        uint8 max = ADVCONFIG_NAME_MAX - (tagged ? ADVFRAME_TAG_LEN : 0u);
+        uint8 nameLen;
+        uint8 start = i;
+        
+        if((options & ADVCONFIG_OPT_SERIAL) != 0u) max -= SERIAL_LEN;
+        nameLen = (len > max) ? max : len;
+        i += 2u;
+        for(n = 0u; n < nameLen; n++) adv[i++] = valid ? cfg[8u + n] : (uint8)defaultName[n];
+        if((options & ADVCONFIG_OPT_SERIAL) != 0u){
+            adv[i++] = '-';
+            adv[i++] = (uint8)hexDigits[cfg[7] >> 4]; // Serial, high byte first
+            adv[i++] = (uint8)hexDigits[cfg[7] & 0x0Fu];
+            adv[i++] = (uint8)hexDigits[cfg[6] >> 4];
+            adv[i++] = (uint8)hexDigits[cfg[6] & 0x0Fu];
+        }
+        adv[start] = (uint8)(i - start - 1u);
+        adv[start + 1u] = AD_TYPE_NAME;
+    }
+    
+    for(n = 0u; n < i; n++) prefix[n] = adv[n];
+    prefixLen = i;
+    AdvFrame_SetLayout(i, company);
+    AdvFrame_SetKey(tagged ? key : 0);
+    if(hasFrame && !tagged){ // A tagged frame waits for the next AdvFrame_Encode()
+        frameBytes[0] = (uint8)(ADVFRAME_LEN - 1u);
+        frameBytes[2] = (uint8)(company & 0xFFu);
+        frameBytes[3] = (uint8)(company >> 8);
+        for(n = 0u; n < ADVFRAME_LEN; n++) adv[i + n] = frameBytes[n];
+        i += ADVFRAME_LEN;
+    }
+    cyBle_discoveryModeInfo.advData->advDataLen = i;
+    return 1u;
+}
+
+/*******************************************************************
+* NAME :            void AdvConfig_Restore()
+*
+* DESCRIPTION :     Put the flags and the name back in front of the
+*                   frame after another format used the advertising
+*                   data, e.g. Eddystone
+*/
+void AdvConfig_Restore(void){
+    uint8 *adv = cyBle_discoveryModeInfo.advData->advData;
+    uint8 i;
+    
+    for(i = 0u; i < prefixLen; i++) adv[i] = prefix[i];
+}
+
+/* [] END OF FILE */
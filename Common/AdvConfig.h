@@ -0,0 +1,42 @@
+/* ========================================
+ * Air Quality Beacon, part of the hackAIR project.
+ * Freely available under CC BY 4.0
+ *
+ * Advertising layout from the unit configuration in SFLASH user
+ * row 0, shared by all sensor firmwares. The flags, the local name
+ * and the AdvFrame position are written into the advertising data
+ * at boot instead of coming from the generated BLE component, so
+ * units can be relabelled without a firmware build. Without a
+ * valid block the generated "Air Beacon" layout is kept.
+ *
+ *   [16-17] 'h', 'A' marks a valid block
+ *   [18]    ADVCONFIG_OPT_* options
+ *   [19]    Name length, up to ADVCONFIG_NAME_MAX
+ *   [20-21] Company ID, little endian
+ *   [22-23] Unit serial, little endian
+ *   [24-33] Name, ASCII
+ *   [48-63] Frame tag key, with ADVCONFIG_OPT_TAG
+ *
+ * http://www.hackair.eu/
+*/
+#ifndef ADVCONFIG_H
+#define ADVCONFIG_H
+
+#include <project.h>
+
+#define ADVCONFIG_BLOCK         ((reg8 *)(CY_SFLASH_USERBASE + 16u))
+#define ADVCONFIG_BLOCK_LEN     (18u)
+#define ADVCONFIG_NAME_MAX      (10u)   // What fits next to the flags and the frame, 4 less with the tag
+#define ADVCONFIG_KEY           ((reg8 *)(CY_SFLASH_USERBASE + 48u))
+
+/* Options */
+#define ADVCONFIG_OPT_SERIAL    (0x01u) // Append "-" and the serial in hex to the name
+#define ADVCONFIG_OPT_NO_NAME   (0x02u) // Leave the name out, the frame identifies the unit
+#define ADVCONFIG_OPT_TAG       (0x04u) // Tag frames with the key, see AdvFrame.h
+
+uint8 AdvConfig_Update(void);
+void AdvConfig_Restore(void);
+
+#endif /* ADVCONFIG_H */
+
+/* [] END OF FILE */
@@ -0,0 +1,250 @@
+/* ========================================
+ * Air Quality Beacon, part of the hackAIR project.
+ * Freely available under CC BY 4.0
+ *
+ * http://www.hackair.eu/
+*/
+#include "AdvFrame.h"
+#include "SipHash.h"
+
+#define TAGGED_FROM         (2u)    // Tag covers the company ID to the end of the body
+
+static uint8 keyEpoch;      // +1 per AdvFrame_SetKey()
+static uint8 offset = ADVFRAME_OFFSET;
+static uint16 company = ADVFRAME_COMPANY_ID;
+static const uint8 *key;    // SIPHASH_KEY_LEN bytes, 0 for untagged frames
+
+/* Tag of a frame starting with its AD length, big endian */
+static void putTag(const uint8 frame[], const uint8 *tagKey, uint8 tag[]){
+    uint32 t = (uint32)SipHash_24(tagKey, &frame[TAGGED_FROM], (uint8)(ADVFRAME_LEN - TAGGED_FROM));
+    
+    tag[0] = (uint8)(t >> 24);
+    tag[1] = (uint8)(t >> 16);
+    tag[2] = (uint8)(t >> 8);
+    tag[3] = (uint8)t;
+}
+
+/* hackAIR frame among the AD structures, wherever the name puts it */
+static const uint8 *findFrame(const uint8 adv[], uint8 len){
+    uint8 i = 0u;
+    
+    while((i < len) && (adv[i] != 0u)){
+        const uint8 *p = &adv[i];
+        
+        if(((uint16)i + p[0] + 1u) > len) break; // Truncated structure
+        if(((p[0] == (ADVFRAME_LEN - 1u)) || (p[0] == (ADVFRAME_LEN + ADVFRAME_TAG_LEN - 1u))) &&
+           (p[1] == ADVFRAME_AD_TYPE) &&
+           (p[2] == (uint8)(company & 0xFFu)) && (p[3] == (uint8)(company >> 8)) &&
+           ((p[4] >> 4) == ADVFRAME_VERSION)){
+            return p;
+        }
+        i += (uint8)(p[0] + 1u);
+    }
+    return 0;
+}
+
+/*******************************************************************
+* NAME :            void AdvFrame_SetLayout(uint8 frameOffset, uint16 companyId)
+*
+* DESCRIPTION :     Where the frame goes in the advertising data and
+*                   the company ID it carries. Defaults are
+*                   ADVFRAME_OFFSET and ADVFRAME_COMPANY_ID.
+*/
+void AdvFrame_SetLayout(uint8 frameOffset, uint16 companyId){
+    offset = frameOffset;
+    company = companyId;
+}
+
+uint8 AdvFrame_Offset(void){
+    return offset;
+}
+
+uint16 AdvFrame_Company(void){
+    return company;
+}
+
+/*******************************************************************
+* NAME :            void AdvFrame_SetKey(const uint8 *tagKey)
+*
+* DESCRIPTION :     Tag frames from now on, 0 stops tagging
+* INPUTS :
+*       uint8 *tagKey   SIPHASH_KEY_LEN bytes, kept by reference
+*/
+void AdvFrame_SetKey(const uint8 *tagKey){
+    key = tagKey;
+    keyEpoch++; // Tags are made again, sequence numbers stay
+}
+
+/*******************************************************************
+* NAME :            uint8 AdvFrame_Encode(ADVFRAME_T *frame, uint8 adv[])
+*
+* DESCRIPTION :     Write the frame into the advertising data at
+*                   the offset set by AdvFrame_SetLayout(). Each
+*                   ADVFRAME_T keeps its own sequence number and tag,
+*                   both only move on when its content differs from
+*                   the last time it was encoded, so pages taking
+*                   turns in the advertisement go out as they were.
+*                   Start with a zeroed ADVFRAME_T.
+* OUTPUTS :
+*       uint8 Advertising data length to use
+*/
+uint8 AdvFrame_Encode(ADVFRAME_T *frame, uint8 adv[]){
+    uint8 bytes[ADVFRAME_LEN];
+    uint8 *p = bytes;
+    uint8 len = (uint8)(ADVFRAME_LEN + ((key != 0) ? ADVFRAME_TAG_LEN : 0u));
+    uint8 changed = 0u;
+    uint8 i;
+    
+    *p++ = (uint8)(len - 1u);
+    *p++ = ADVFRAME_AD_TYPE;
+    *p++ = (uint8)(company & 0xFFu);
+    *p++ = (uint8)(company >> 8);
+    *p++ = (uint8)((ADVFRAME_VERSION << 4) | (frame->type & 0x0Fu));
+    *p++ = frame->sensor;
+    *p++ = frame->seq;
+    *p++ = (uint8)(((frame->health & 0x0Fu) << 4) | (frame->flags & 0x0Fu));
+    for(i = 0u; i < ADVFRAME_BODY_LEN; i++) *p++ = frame->body[i];
+    
+    for(i = 0u; i < ADVFRAME_LEN; i++){
+        if(frame->image[i] != bytes[i]) changed = 1u;
+    }
+    if(changed) bytes[6] = ++frame->seq;
+    if(changed || (frame->keyEpoch != keyEpoch)){
+        for(i = 0u; i < ADVFRAME_LEN; i++) frame->image[i] = bytes[i];
+        if(key != 0) putTag(bytes, key, &frame->image[ADVFRAME_LEN]);
+        frame->keyEpoch = keyEpoch;
+    }
+    for(i = 0u; i < len; i++) adv[offset + i] = frame->image[i];
+    return (uint8)(offset + len);
+}
+
+/*******************************************************************
+* NAME :            uint8 AdvFrame_Decode(adv, len, frame)
+*
+* DESCRIPTION :     Find a hackAIR frame among the AD structures of
+*                   an advertisement, wherever the name puts it. The
+*                   tag is not checked, see AdvFrame_Verify().
+* OUTPUTS :
+*       uint8 1 if a frame of this format version was found
+*/
+uint8 AdvFrame_Decode(const uint8 adv[], uint8 len, ADVFRAME_T *frame){
+    const uint8 *p = findFrame(adv, len);
+    uint8 j;
+    
+    if(p == 0) return 0u;
+    frame->type = p[4] & 0x0Fu;
+    frame->sensor = p[5];
+    frame->seq = p[6];
+    frame->health = p[7] >> 4;
+    frame->flags = p[7] & 0x0Fu;
+    for(j = 0u; j < ADVFRAME_BODY_LEN; j++) frame->body[j] = p[8u + j];
+    return 1u;
+}
+
+/*******************************************************************
+* NAME :            uint8 AdvFrame_Verify(adv, len, tagKey)
+*
+* DESCRIPTION :     Check the tag of the frame in an advertisement,
+*                   for receivers
+* INPUTS :
+*       uint8 *tagKey   SIPHASH_KEY_LEN bytes of the sending unit
+* OUTPUTS :
+*       uint8 ADVFRAME_TAG_OK, ADVFRAME_TAG_BAD or ADVFRAME_TAG_NONE
+*/
+uint8 AdvFrame_Verify(const uint8 adv[], uint8 len, const uint8 *tagKey){
+    const uint8 *p = findFrame(adv, len);
+    uint8 tag[ADVFRAME_TAG_LEN];
+    uint8 diff = 0u;
+    uint8 j;
+    
+    if((p == 0) || (p[0] != (ADVFRAME_LEN + ADVFRAME_TAG_LEN - 1u))) return ADVFRAME_TAG_NONE;
+    putTag(p, tagKey, tag);
+    for(j = 0u; j < ADVFRAME_TAG_LEN; j++) diff |= (uint8)(tag[j] ^ p[ADVFRAME_LEN + j]);
+    return (diff == 0u) ? ADVFRAME_TAG_OK : ADVFRAME_TAG_BAD;
+}
+
+/*******************************************************************
+* NAME :            void AdvFrame_PutMeasurement(body, pm1, pm25, pm10, raw, battery)
+*
+* DESCRIPTION :     Fill a measurement body, see AdvFrame.h
+* INPUTS :
+*       uint16 pm1, pm25, pm10  0.1ug/m^3 or ADVFRAME_NA
+*       uint16 raw              Sensor units or ADVFRAME_NA
+*       uint8 battery           % or ADVFRAME_BATTERY_NA
+*/
+void AdvFrame_PutMeasurement(uint8 body[], uint16 pm1, uint16 pm25, uint16 pm10, uint16 raw, uint8 battery){
+    uint32 packed = ((uint32)AdvFrame_PmEncode(pm1) << 22) |
+                    ((uint32)AdvFrame_PmEncode(pm25) << 12) |
+                    ((uint32)AdvFrame_PmEncode(pm10) << 2);
+    
+    body[0] = (uint8)(packed >> 24);
+    body[1] = (uint8)(packed >> 16);
+    body[2] = (uint8)(packed >> 8);
+    body[3] = (uint8)packed;
+    body[4] = (uint8)(raw >> 8);
+    body[5] = (uint8)raw;
+    body[6] = battery;
+    body[7] = 0u;
+}
+
+/*******************************************************************
+* NAME :            uint16 AdvFrame_GetPm(const uint8 body[], uint8 idx)
+*
+* DESCRIPTION :     PM value of a measurement body
+* INPUTS :
+*       uint8 idx       0 PM1, 1 PM2.5, 2 PM10
+* OUTPUTS :
+*       uint16 0.1ug/m^3 or ADVFRAME_NA
+*/
+uint16 AdvFrame_GetPm(const uint8 body[], uint8 idx){
+    uint32 packed = ((uint32)body[0] << 24) | ((uint32)body[1] << 16) | ((uint32)body[2] << 8) | body[3];
+    
+    return AdvFrame_PmDecode((uint16)((packed >> (22u - (10u * idx))) & 0x3FFu));
+}
+
+uint16 AdvFrame_GetU16(const uint8 body[], uint8 idx){
+    return (uint16)(((uint16)body[idx] << 8) | body[idx + 1u]);
+}
+
+/*******************************************************************
+* NAME :            uint16 AdvFrame_PmEncode(uint16 value)
+*
+* DESCRIPTION :     10 bit quasi logarithmic PM code, see AdvFrame.h
+* INPUTS :
+*       uint16 value    0.1ug/m^3 or ADVFRAME_NA
+*/
+uint16 AdvFrame_PmEncode(uint16 value){
+    uint32 v = value;
+    uint8 e = 1u;
+    
+    if(value == ADVFRAME_NA) return ADVFRAME_PM_NA;
+    if(v < 64u) return value;
+    while((v >> (e - 1u)) > 127u) e++;
+    if(e > 1u){
+        v = (v + (1uL << (e - 2u))) >> (e - 1u); // Round to nearest
+        if(v > 127u){
+            v >>= 1;
+            e++;
+        }
+    }
+    return (uint16)(((uint16)e << 6) | (v - 64u));
+}
+
+/*******************************************************************
+* NAME :            uint16 AdvFrame_PmDecode(uint16 code)
+*
+* DESCRIPTION :     Value of a 10 bit PM code
+* OUTPUTS :
+*       uint16 0.1ug/m^3 or ADVFRAME_NA
+*/
+uint16 AdvFrame_PmDecode(uint16 code){
+    uint8 e = (uint8)((code >> 6) & 0x0Fu);
+    uint32 v;
+    
+    if(code == ADVFRAME_PM_NA) return ADVFRAME_NA;
+    if(e == 0u) return code & 0x3Fu;
+    v = (uint32)(64u + (code & 0x3Fu)) << (e - 1u);
+    return (v > 0xFFFEu) ? 0xFFFEu : (uint16)v;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,130 @@
+/* ========================================
+ * Air Quality Beacon, part of the hackAIR project.
+ * Freely available under CC BY 4.0
+ *
+ * hackAIR advertising frame, shared by all sensor firmwares and by
+ * receivers. The frame is the manufacturer specific data structure
+ * that follows the flags and the local name in the advertisement,
+ * its offset and company ID come from AdvFrame_SetLayout():
+ *
+ *   [0]     AD length
+ *   [1]     0xFF, manufacturer specific data
+ *   [2-3]   Company ID, little endian
+ *   [4]     Format version (high nibble), frame type (low nibble)
+ *   [5]     Sensor type
+ *   [6]     Sequence number, +1 per change of this frame type
+ *   [7]     Health (high nibble), flags (low nibble)
+ *   [8-15]  Body, layout per frame type, multi byte fields big endian
+ *   [16-19] Tag, only on units with a key, see below
+ *
+ * Measurement body:
+ *   [0-3]   PM1, PM2.5, PM10 as 10 bit codes, packed from bit 31
+ *           down, big endian, bits 1-0 zero
+ *   [4-5]   Raw sensor output (mV for DN7C3CA006/GP2Y1010AU0F,
+ *           pcs/0.01cf for PPD42)
+ *   [6]     Battery level in %
+ *   [7]     Reserved, 0
+ * The PM code is quasi logarithmic over 0.1ug/m^3 steps: exponent
+ * (high 4 bits) and mantissa (low 6 bits). Exponent 0 holds 0-6.3
+ * exactly, exponent e > 0 holds (64 + mantissa) << (e - 1), rounded
+ * to the nearest step, which is within 0.8% up to 6553.5ug/m^3.
+ * The full 16 bit range ends at code 704, higher codes are unused.
+ * Absent values are ADVFRAME_NA on the encoder side, which codes to
+ * ADVFRAME_PM_NA, and ADVFRAME_BATTERY_NA.
+ * The tag lets receivers drop corrupted and forged frames before
+ * any plausibility check: the low 32 bits of SipHash-2-4 over bytes
+ * 2-15 (company ID to the end of the body, sequence number
+ * included) with the 128 bit key of the unit, big endian. The AD
+ * length tells whether a frame is tagged. It is computed once per
+ * changed frame, a repeated frame keeps its tag.
+ * No hardware access. Build with HACKAIR_HOST to use it on a PC,
+ * with SipHash.c for AdvFrame_Verify().
+ *
+ * http://www.hackair.eu/
+*/
+#ifndef ADVFRAME_H
+#define ADVFRAME_H
+
+#ifdef HACKAIR_HOST
+#include <stdint.h>
+typedef uint8_t uint8;
+typedef uint16_t uint16;
+typedef uint32_t uint32;
+typedef int16_t int16;
+#else
+#include <cytypes.h>
+#endif
+
+#define ADVFRAME_VERSION        (2u)
+#define ADVFRAME_OFFSET         (15u)       // Default, after the flags and the "Air Beacon" name
+#define ADVFRAME_COMPANY_ID     (0x0131u)   // Default, Cypress Semiconductor
+#define ADVFRAME_AD_TYPE        (0xFFu)     // Manufacturer specific data
+#define ADVFRAME_HEADER_LEN     (4u)
+#define ADVFRAME_BODY_LEN       (8u)
+#define ADVFRAME_LEN            (4u + ADVFRAME_HEADER_LEN + ADVFRAME_BODY_LEN)
+#define ADVFRAME_TAG_LEN        (4u)        // Appended with AdvFrame_SetKey()
+#define ADVFRAME_NA             (0xFFFFu)   // Value not provided by this sensor
+#define ADVFRAME_PM_NA          (0x3FFu)    // PM code for ADVFRAME_NA
+#define ADVFRAME_BATTERY_NA     (0xFFu)     // No battery sense
+#define ADVFRAME_SCAN_REQ_NA    (0xFFu)     // Beacon body [7], build can't count scan requests
+
+/* Frame types */
+#define ADVFRAME_TYPE_MEASUREMENT   (0u)
+#define ADVFRAME_TYPE_ENERGY        (1u)    // Energy_WriteFrame(), CPU duty cycle in 0.1% steps
+#define ADVFRAME_TYPE_SUPERVISOR    (2u)    // Supervisor_WriteFrame(), wake latency in 10ms steps
+#define ADVFRAME_TYPE_HISTOGRAM     (3u)    // Pulse count, PulseCapture_ReadHistogram() bins
+#define ADVFRAME_TYPE_HISTORY       (4u)    // Scan response only, see History.h
+#define ADVFRAME_TYPE_BEACON        (5u)    // Beacon_WriteFrame()
+
+/* Sensor types */
+#define ADVFRAME_SENSOR_SEN0177     (1u)
+#define ADVFRAME_SENSOR_SDS011      (2u)
+#define ADVFRAME_SENSOR_GP2Y1010    (3u)
+#define ADVFRAME_SENSOR_DN7C3CA006  (4u)
+#define ADVFRAME_SENSOR_PPD42       (5u)
+
+/* Health nibble */
+#define ADVFRAME_HEALTH_WARMUP      (0x01u) // Sensor not settled yet
+#define ADVFRAME_HEALTH_SENSOR_FAULT (0x02u) // Sensor stopped answering
+#define ADVFRAME_HEALTH_WDT_RESET   (0x04u) // Last reset was a supervisor reset
+#define ADVFRAME_HEALTH_LOW_BATTERY (0x08u) // No battery sense on current boards
+
+/* AdvFrame_Verify() results */
+#define ADVFRAME_TAG_NONE           (0u)    // No frame, or an untagged one
+#define ADVFRAME_TAG_OK             (1u)
+#define ADVFRAME_TAG_BAD            (2u)
+
+/* Flags nibble */
+#define ADVFRAME_FLAG_BURST         (0x01u) // Fast sampling after a change
+#define ADVFRAME_FLAG_LONG_INTERVAL (0x02u) // Dormant between reports
+
+typedef struct
+{
+    uint8 type;                     // ADVFRAME_TYPE_*
+    uint8 sensor;                   // ADVFRAME_SENSOR_*
+    uint8 seq;                      // Set by AdvFrame_Encode()
+    uint8 health;                   // ADVFRAME_HEALTH_*
+    uint8 flags;                    // ADVFRAME_FLAG_*
+    uint8 body[ADVFRAME_BODY_LEN];
+    uint8 image[ADVFRAME_LEN + ADVFRAME_TAG_LEN]; // Last encoded, tag included, AdvFrame_Encode() only
+    uint8 keyEpoch;                 // AdvFrame_SetKey() the tag was made after
+} ADVFRAME_T;
+
+void AdvFrame_SetLayout(uint8 frameOffset, uint16 companyId);
+uint8 AdvFrame_Offset(void);
+uint16 AdvFrame_Company(void);
+void AdvFrame_SetKey(const uint8 *tagKey);
+uint8 AdvFrame_Encode(ADVFRAME_T *frame, uint8 adv[]);
+uint8 AdvFrame_Decode(const uint8 adv[], uint8 len, ADVFRAME_T *frame);
+uint8 AdvFrame_Verify(const uint8 adv[], uint8 len, const uint8 *tagKey);
+
+void AdvFrame_PutMeasurement(uint8 body[], uint16 pm1, uint16 pm25, uint16 pm10, uint16 raw, uint8 battery);
+uint16 AdvFrame_GetPm(const uint8 body[], uint8 idx);
+uint16 AdvFrame_GetU16(const uint8 body[], uint8 idx);
+
+uint16 AdvFrame_PmEncode(uint16 value);
+uint16 AdvFrame_PmDecode(uint16 code);
+
+#endif /* ADVFRAME_H */
+
+/* [] END OF FILE */
@@ -0,0 +1,100 @@
+/* ========================================
+ * Air Quality Beacon, part of the hackAIR project.
+ * Freely available under CC BY 4.0
+ *
+ * http://www.hackair.eu/
+*/
+#include "AdvPages.h"
+
+#define NO_PAGE     (0xFFu)
+
+static const ADVPAGES_CONFIG_T *cfg;
+static ADVFRAME_T pages[ADVPAGES_COUNT];
+static int16 credit[ADVPAGES_COUNT];
+static uint8 ready;                 // Bit per page that has content
+
+/*******************************************************************
+* NAME :            void AdvPages_Init(const ADVPAGES_CONFIG_T *config, uint8 sensor)
+*
+* DESCRIPTION :     Start with all pages empty
+* INPUTS :
+*       ADVPAGES_CONFIG_T *config   Page mix, kept by reference
+*       uint8 sensor                ADVFRAME_SENSOR_* for all pages
+*/
+void AdvPages_Init(const ADVPAGES_CONFIG_T *config, uint8 sensor){
+    uint8 i;
+    
+    cfg = config;
+    ready = 0u;
+    for(i = 0u; i < ADVPAGES_COUNT; i++){
+        pages[i].type = i;
+        pages[i].sensor = sensor;
+    }
+    AdvPages_Restart();
+}
+
+/*******************************************************************
+* NAME :            ADVFRAME_T *AdvPages_Edit(uint8 type)
+*
+* DESCRIPTION :     Page to fill in, it takes part in the rotation
+*                   from now on. Health and flags are set when the
+*                   page goes out.
+*/
+ADVFRAME_T *AdvPages_Edit(uint8 type){
+    if(type >= ADVPAGES_COUNT) type = ADVPAGES_PRIMARY;
+    ready |= (uint8)(1u << type);
+    return &pages[type];
+}
+
+/*******************************************************************
+* NAME :            void AdvPages_Drop(uint8 type)
+*
+* DESCRIPTION :     Take a page out of the rotation until the next
+*                   AdvPages_Edit(), e.g. after the unit
+*                   configuration turned its frame type off
+*/
+void AdvPages_Drop(uint8 type){
+    if(type >= ADVPAGES_COUNT) return;
+    ready &= (uint8)~(1u << type);
+    credit[type] = 0;
+}
+
+/*******************************************************************
+* NAME :            ADVFRAME_T *AdvPages_Next(uint8 primaryOnly)
+*
+* DESCRIPTION :     Page for the next advertising event
+* INPUTS :
+*       uint8 primaryOnly   Only the measurement page, e.g. in a burst
+* OUTPUTS :
+*       ADVFRAME_T* 0 while no page has content
+*/
+ADVFRAME_T *AdvPages_Next(uint8 primaryOnly){
+    int16 total = 0;
+    uint8 best = NO_PAGE;
+    uint8 i;
+    
+    for(i = 0u; i < ADVPAGES_COUNT; i++){
+        if(((ready & (1u << i)) == 0u) || (cfg->weight[i] == 0u)) continue;
+        if(primaryOnly && (i != ADVPAGES_PRIMARY)) continue;
+        credit[i] += cfg->weight[i];
+        total += cfg->weight[i];
+        if((best == NO_PAGE) || (credit[i] > credit[best])) best = i;
+    }
+    if(best == NO_PAGE) return 0;
+    credit[best] -= total;
+    return &pages[best];
+}
+
+/*******************************************************************
+* NAME :            void AdvPages_Restart()
+*
+* DESCRIPTION :     Start the rotation over, the heaviest page goes
+*                   out next. Call after a new measurement.
+*/
+void AdvPages_Restart(void){
+    uint8 i;
+    
+    for(i = 0u; i < ADVPAGES_COUNT; i++) credit[i] = 0;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,39 @@
+/* ========================================
+ * Air Quality Beacon, part of the hackAIR project.
+ * Freely available under CC BY 4.0
+ *
+ * Rotating advertising pages shared by all sensor firmwares. One
+ * AdvFrame per frame type is kept up to date by the measurement
+ * code, and a different one goes out on each advertising event so
+ * receivers collect the full telemetry without connecting. The
+ * frame type in each packet is the page index. Pages are picked by
+ * smooth weighted round robin: a page of weight 4 next to three of
+ * weight 1 goes out 4 times in 7, spread evenly. The last two
+ * pages are the Eddystone frames, their ADVFRAME_T is unused. No
+ * hardware access.
+ *
+ * http://www.hackair.eu/
+*/
+#ifndef ADVPAGES_H
+#define ADVPAGES_H
+
+#include "AdvFrame.h"
+
+#define ADVPAGES_COUNT      (8u)    // Frame types up to ADVFRAME_TYPE_BEACON, then
+                                    // EDDYSTONE_PAGE_UID and EDDYSTONE_PAGE_TLM
+#define ADVPAGES_PRIMARY    (ADVFRAME_TYPE_MEASUREMENT)
+
+typedef struct
+{
+    uint8 weight[ADVPAGES_COUNT];   // Share per frame type, 0 never goes out
+} ADVPAGES_CONFIG_T;
+
+void AdvPages_Init(const ADVPAGES_CONFIG_T *config, uint8 sensor);
+ADVFRAME_T *AdvPages_Edit(uint8 type);
+void AdvPages_Drop(uint8 type);
+ADVFRAME_T *AdvPages_Next(uint8 primaryOnly);
+void AdvPages_Restart(void);
+
+#endif /* ADVPAGES_H */
+
+/* [] END OF FILE */
@@ -0,0 +1,72 @@
+/* ========================================
+ * Air Quality Beacon, part of the hackAIR project.
+ * Freely available under CC BY 4.0
+ *
+ * http://www.hackair.eu/
+*/
+#include "AdvPolicy.h"
+
+static const ADVPOLICY_CONFIG_T *cfg;
+static uint16 reference;    // Value at the last significant change
+static uint16 interval;
+static uint8 fastLeft;      // Measurements left at minInterval
+static uint8 attended;      // Scan requests within ADVPOLICY_QUIET_SECS
+
+/*******************************************************************
+* NAME :            void AdvPolicy_Init(const ADVPOLICY_CONFIG_T *config)
+*
+* DESCRIPTION :     Start at the minimum interval, the first
+*                   measurement becomes the reference
+*/
+void AdvPolicy_Init(const ADVPOLICY_CONFIG_T *config){
+    cfg = config;
+    reference = 0u;
+    interval = cfg->minInterval;
+    fastLeft = cfg->fastCycles;
+}
+
+/*******************************************************************
+* NAME :            uint16 AdvPolicy_Update(uint16 value)
+*
+* DESCRIPTION :     Feed one measurement
+* INPUTS :
+*       uint16 value    Measurement in sensor units
+* OUTPUTS :
+*       uint16 Adv interval to use, 0.625ms units
+*/
+uint16 AdvPolicy_Update(uint16 value){
+    uint16 diff = (value > reference) ? (value - reference) : (reference - value);
+    uint32 threshold = ((uint32)reference * cfg->relPermille) / 1000u;
+    
+    if(threshold < cfg->absThreshold) threshold = cfg->absThreshold;
+    
+    if(diff >= threshold){ // Significant change, advertise fast
+        reference = value;
+        interval = cfg->minInterval;
+        fastLeft = cfg->fastCycles;
+    }else if(fastLeft != 0u){
+        fastLeft--;
+    }else if(interval < cfg->maxInterval){ // Stable, back off
+        interval = (interval > (cfg->maxInterval / 2u)) ? cfg->maxInterval : (uint16)(interval * 2u);
+    }
+    if(attended && (interval > ADVPOLICY_ATTENDED_MAX)){ // Someone is scanning, keep them served
+        interval = (cfg->minInterval > ADVPOLICY_ATTENDED_MAX) ? cfg->minInterval : ADVPOLICY_ATTENDED_MAX;
+    }
+    return interval;
+}
+
+/*******************************************************************
+* NAME :            void AdvPolicy_ScanQuiet(uint16 secs)
+*
+* DESCRIPTION :     Time since the last scan request, before the
+*                   next AdvPolicy_Update()
+*/
+void AdvPolicy_ScanQuiet(uint16 secs){
+    attended = (secs < ADVPOLICY_QUIET_SECS) ? 1u : 0u;
+}
+
+uint16 AdvPolicy_Interval(void){
+    return interval;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,55 @@
+/* ========================================
+ * Air Quality Beacon, part of the hackAIR project.
+ * Freely available under CC BY 4.0
+ *
+ * Advertising interval policy shared by all sensor firmwares.
+ * A significant change of the measured value drops the interval to
+ * its minimum so phones in range pick the new value up quickly,
+ * stable values double it per measurement up to the maximum. While
+ * scan requests show someone is listening the interval stays at
+ * ADVPOLICY_ATTENDED_MAX or below, after ADVPOLICY_QUIET_SECS
+ * without one it backs off again. No hardware access, the caller
+ * applies the returned interval. Build with HACKAIR_HOST to use it
+ * on a PC.
+ *
+ * http://www.hackair.eu/
+*/
+#ifndef ADVPOLICY_H
+#define ADVPOLICY_H
+
+#ifdef HACKAIR_HOST
+#include <stdint.h>
+typedef uint8_t uint8;
+typedef uint16_t uint16;
+typedef uint32_t uint32;
+#else
+#include <cytypes.h>
+#endif
+
+typedef struct
+{
+    uint16 minInterval;     // Adv interval after a change, 0.625ms units
+    uint16 maxInterval;     // Adv interval for stable values, 0.625ms units
+    uint16 absThreshold;    // Change that always counts, in sensor units
+    uint16 relPermille;     // Change relative to the reference value
+    uint8  fastCycles;      // Measurements to stay at minInterval
+} ADVPOLICY_CONFIG_T;
+
+/* 100ms (non connectable minimum) up to 4s, 20% change */
+#define ADVPOLICY_DEFAULT_MIN       (0x00A0u)
+#define ADVPOLICY_DEFAULT_MAX       (0x1900u)
+#define ADVPOLICY_DEFAULT_REL       (200u)
+#define ADVPOLICY_DEFAULT_FAST      (3u)
+
+/* 500ms while scanned, until 3 minutes without a scan request */
+#define ADVPOLICY_ATTENDED_MAX      (0x0320u)
+#define ADVPOLICY_QUIET_SECS        (180u)
+
+void AdvPolicy_Init(const ADVPOLICY_CONFIG_T *config);
+uint16 AdvPolicy_Update(uint16 value);
+void AdvPolicy_ScanQuiet(uint16 secs);
+uint16 AdvPolicy_Interval(void);
+
+#endif /* ADVPOLICY_H */
+
+/* [] END OF FILE */
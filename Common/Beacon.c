@@ -0,0 +1,342 @@
+/* ========================================
+ * Air Quality Beacon, part of the hackAIR project.
+ * Freely available under CC BY 4.0
+ *
+ * http://www.hackair.eu/
+*/
+#include "Beacon.h"
+#include "LpTimer.h"
+#include "Energy.h"
+#include "TxPower.h"
+#include "Settings.h"
+#include "AdvFrame.h"
+
+extern CYBLE_GAPP_DISC_MODE_INFO_T cyBle_discoveryModeInfo;
+
+static uint16 interval = CYBLE_FAST_ADV_INT_MIN;
+static uint8 restartPending;
+static uint8 txLevel = CYBLE_TX_POWER_LEVEL_ADV;
+
+static uint8 advShadow[CYBLE_GAP_MAX_ADV_DATA_LEN];     // Data the link layer has
+static uint8 rspShadow[CYBLE_GAP_MAX_SCAN_RSP_DATA_LEN];
+static uint8 advShadowLen;
+static uint8 rspShadowLen;
+static uint8 commitPending;
+static uint16 committed;    // Updates handed to the link layer
+static uint16 skipped;      // Updates equal to the committed data
+static uint16 deferred;     // Updates that waited for the end of a radio event
+static uint32 events;       // Advertising events since power up, estimated
+static uint32 eventsSince;  // LF time events were counted up to
+static uint32 eventTicks;   // Interval in LF ticks, 0 while not advertising
+static uint16 scanReqs;     // Scan requests in the stats window
+static uint32 lastScanAt;   // LF time of the last scan request
+static uint8 scanned;       // Any scan request since power up
+
+/* Copy the current data, return 1 if it differed from the shadow */
+static uint8 syncShadow(void){
+    CYBLE_GAPP_DISC_DATA_T *adv = cyBle_discoveryModeInfo.advData;
+    CYBLE_GAPP_SCAN_RSP_DATA_T *rsp = cyBle_discoveryModeInfo.scanRspData;
+    uint8 changed = (adv->advDataLen != advShadowLen) || (rsp->scanRspDataLen != rspShadowLen);
+    uint8 i;
+    
+    for(i = 0u; i < adv->advDataLen; i++){
+        if(advShadow[i] != adv->advData[i]) changed = 1u;
+        advShadow[i] = adv->advData[i];
+    }
+    for(i = 0u; i < rsp->scanRspDataLen; i++){
+        if(rspShadow[i] != rsp->scanRspData[i]) changed = 1u;
+        rspShadow[i] = rsp->scanRspData[i];
+    }
+    advShadowLen = adv->advDataLen;
+    rspShadowLen = rsp->scanRspDataLen;
+    return changed;
+}
+
+/* Count the events since eventsSince at the running interval */
+static void countEvents(uint32 now){
+    if(eventTicks != 0u){
+        uint32 n = (now - eventsSince) / eventTicks;
+        events += n;
+        eventsSince += n * eventTicks;
+    }
+}
+
+/* Radio charge per event is fixed for a level, average current scales with the rate */
+static void scaleRadio(void){
+    uint32 ratePermille = ((uint32)CYBLE_FAST_ADV_INT_MIN * 1000u) / interval;
+    
+    Energy_ScaleLoad(ENERGY_RADIO, (uint16)((ratePermille * TxPower_RadioPermille(txLevel)) / 1000u), LpTimer_Now());
+}
+
+/* The stack starts at the component level after CyBle_Start() */
+static void applyTxPower(void){
+    CYBLE_BLESS_PWR_IN_DB_T power;
+    
+    power.blePwrLevelInDbm = (CYBLE_BLESS_PWR_LVL_T)txLevel;
+    power.bleSsChId = CYBLE_LL_ADV_CH_TYPE;
+    (void)CyBle_SetTxPowerLevel(&power);
+}
+
+/* Saturating counter */
+static void count(uint16 *counter){
+    if(*counter < 0xFFFFu) (*counter)++;
+}
+
+/*******************************************************************
+* NAME :            void Beacon_StartAdvertising()
+*
+* DESCRIPTION :     Start advertising with the current interval.
+*                   Call on CYBLE_EVT_STACK_ON.
+*/
+void Beacon_StartAdvertising(void){
+    cyBle_discoveryModeInfo.advParam->advIntvMin = interval;
+    cyBle_discoveryModeInfo.advParam->advIntvMax = interval;
+    if(Beacon_Scannable()){
+#if (CYBLE_GAP_ROLE_PERIPHERAL)
+        cyBle_discoveryModeInfo.advParam->advType = CYBLE_GAPP_CONNECTABLE_UNDIRECTED_ADV; // Also scannable, for the GATT download
+#else
+        cyBle_discoveryModeInfo.advParam->advType = CYBLE_GAPP_SCANNABLE_UNDIRECTED_ADV; // Scan response carries the history
+#endif
+#if (BEACON_SCAN_REQ_EVENTS)
+        (void)CyBle_SetAppEventMask(CYBLE_EVT_GAP_SCAN_REQ_RECVD_MSK);
+#endif
+    }else{
+        cyBle_discoveryModeInfo.advParam->advType = CYBLE_GAPP_NON_CONNECTABLE_UNDIRECTED_ADV; // No receive window after each packet
+    }
+    (void)syncShadow(); // Advertising starts with the current data
+    commitPending = 0u;
+    applyTxPower();
+    if(CyBle_GappStartAdvertisement(CYBLE_ADVERTISING_CUSTOM) == CYBLE_ERROR_OK){
+        scaleRadio();
+        Energy_LoadOn(ENERGY_RADIO, LpTimer_Now());
+        countEvents(LpTimer_Now()); // Old interval up to the restart
+        eventsSince = LpTimer_Now();
+        eventTicks = LpTimer_MsToTicks(Beacon_IntervalMs() + BEACON_ADV_DELAY_MS);
+    }
+}
+
+/*******************************************************************
+* NAME :            void Beacon_SetInterval(uint16 newInterval)
+*
+* DESCRIPTION :     Change the advertising interval, takes effect
+*                   after the stop/start round trip
+* INPUTS :
+*       uint16 newInterval  0.625ms units
+*/
+void Beacon_SetInterval(uint16 newInterval){
+    if(newInterval < CYBLE_GAP_ADV_ADVERT_INTERVAL_NONCON_MIN) newInterval = CYBLE_GAP_ADV_ADVERT_INTERVAL_NONCON_MIN;
+    if(newInterval > CYBLE_GAP_ADV_ADVERT_INTERVAL_MAX) newInterval = CYBLE_GAP_ADV_ADVERT_INTERVAL_MAX;
+    if(newInterval == interval) return;
+    
+    interval = newInterval;
+    if((CyBle_GetState() == CYBLE_STATE_ADVERTISING) && (restartPending == 0u)){
+        restartPending = 1u;
+        CyBle_GappStopAdvertisement();
+    }
+}
+
+/*******************************************************************
+* NAME :            uint8 Beacon_Scannable()
+*
+* DESCRIPTION :     Advertising answers scan requests. Peripheral
+*                   builds stay connectable whatever the flags say,
+*                   non connectable advertising would keep every
+*                   GATT client out until the unit is reprogrammed.
+*                   Broadcasters that can't count scan requests don't
+*                   take them.
+*/
+uint8 Beacon_Scannable(void){
+#if (CYBLE_GAP_ROLE_PERIPHERAL)
+    return 1u;
+#elif (BEACON_SCAN_REQ_EVENTS)
+    return ((SETTINGS_FLAGS & SETTINGS_FLAG_NON_SCANNABLE) == 0u) ? 1u : 0u;
+#else
+    return 0u; // Scan requests would go uncounted
+#endif
+}
+
+/*******************************************************************
+* NAME :            void Beacon_ScanRequest(uint32 now)
+*
+* DESCRIPTION :     Call on CYBLE_EVT_GAP_SCAN_REQ_RECVD
+*/
+void Beacon_ScanRequest(uint32 now){
+    count(&scanReqs);
+    lastScanAt = now;
+    scanned = 1u;
+}
+
+/*******************************************************************
+* NAME :            uint16 Beacon_ScanQuietSecs(uint32 now)
+*
+* DESCRIPTION :     Time since the last scan request
+* OUTPUTS :
+*       uint16 Seconds, 0xFFFF if never scanned or long ago
+*/
+uint16 Beacon_ScanQuietSecs(uint32 now){
+    uint32 secs = (now - lastScanAt) / LpTimer_TicksPerSec();
+    
+    return (!scanned || (secs > 0xFFFFu)) ? 0xFFFFu : (uint16)secs;
+}
+
+void Beacon_ResetWindow(void){
+    scanReqs = 0u;
+}
+
+/*******************************************************************
+* NAME :            void Beacon_SetTxPower(uint8 level)
+*
+* DESCRIPTION :     Change the advertising TX power, takes effect
+*                   from the next advertising event
+* INPUTS :
+*       uint8 level     CYBLE_BLESS_PWR_LVL_T, see TxPower.h
+*/
+void Beacon_SetTxPower(uint8 level){
+    if(level < TXPOWER_LEVEL_MIN) level = TXPOWER_LEVEL_MIN;
+    if(level > TXPOWER_LEVEL_MAX) level = TXPOWER_LEVEL_MAX;
+    if(level == txLevel) return;
+    
+    txLevel = level;
+    if(CyBle_GetState() == CYBLE_STATE_ADVERTISING){
+        applyTxPower();
+        scaleRadio();
+    }
+}
+
+int8 Beacon_TxPowerDbm(void){
+    return TxPower_Dbm(txLevel);
+}
+
+/*******************************************************************
+* NAME :            uint32 Beacon_IntervalMs()
+*
+* DESCRIPTION :     Advertising interval in ms, the new one as soon
+*                   as Beacon_SetInterval() accepted it
+*/
+uint32 Beacon_IntervalMs(void){
+    return ((uint32)interval * 5u) / 8u; // 0.625ms units
+}
+
+/*******************************************************************
+* NAME :            void Beacon_AdvStartStop()
+*
+* DESCRIPTION :     Call on CYBLE_EVT_GAPP_ADVERTISEMENT_START_STOP,
+*                   restarts advertising after an interval change
+*/
+void Beacon_AdvStartStop(void){
+    if((restartPending != 0u) && (CyBle_GetState() == CYBLE_STATE_DISCONNECTED)){
+        restartPending = 0u;
+        Energy_LoadOff(ENERGY_RADIO, LpTimer_Now());
+        Beacon_StartAdvertising();
+    }
+}
+
+/*******************************************************************
+* NAME :            void Beacon_Stopped()
+*
+* DESCRIPTION :     Call when the stack is shut down while
+*                   advertising, stops the event count
+*/
+void Beacon_Stopped(void){
+    countEvents(LpTimer_Now());
+    eventTicks = 0u;
+}
+
+/*******************************************************************
+* NAME :            uint32 Beacon_Events(uint32 now)
+*
+* DESCRIPTION :     Advertising events since power up, from the
+*                   time spent advertising at each interval
+*/
+uint32 Beacon_Events(uint32 now){
+    countEvents(now);
+    return events;
+}
+
+/*******************************************************************
+* NAME :            uint32 Beacon_TicksPastEvent(uint32 now)
+*
+* DESCRIPTION :     Time until just after the next advertising event
+*                   at the interval in force, estimated like
+*                   Beacon_Events(). Paces the page rotation so each
+*                   page goes out before the next one replaces it.
+* OUTPUTS :
+*       uint32 LF ticks, 0 while not advertising
+*/
+uint32 Beacon_TicksPastEvent(uint32 now){
+    if(eventTicks == 0u) return 0u;
+    countEvents(now);
+    return (eventsSince + eventTicks - now) + LpTimer_MsToTicks(BEACON_EVENT_GUARD_MS);
+}
+
+/*******************************************************************
+* NAME :            void Beacon_UpdateData()
+*
+* DESCRIPTION :     Call after writing the advertising or scan
+*                   response data. Unchanged data is not committed,
+*                   changed data is committed now if the radio is
+*                   between events, otherwise from Beacon_Commit().
+*/
+void Beacon_UpdateData(void){
+    uint8 changed = syncShadow();
+    
+    if(!changed && !commitPending){
+        count(&skipped);
+        return;
+    }
+    commitPending = 1u;
+    Beacon_Commit();
+    if(commitPending) count(&deferred);
+}
+
+/*******************************************************************
+* NAME :            void Beacon_Commit()
+*
+* DESCRIPTION :     Hand pending data to the link layer while the
+*                   BLESS sleeps between advertising events. Call
+*                   from the main loop after CyBle_ProcessEvents().
+*                   While not advertising the data waits for
+*                   Beacon_StartAdvertising().
+*/
+void Beacon_Commit(void){
+    CYBLE_BLESS_STATE_T blessState;
+    
+    if(!commitPending || (CyBle_GetState() != CYBLE_STATE_ADVERTISING)) return;
+    blessState = CyBle_GetBleSsState();
+    if((blessState != CYBLE_BLESS_STATE_SLEEP) && (blessState != CYBLE_BLESS_STATE_DEEPSLEEP)) return;
+    
+    if(CyBle_GapUpdateAdvData(cyBle_discoveryModeInfo.advData, cyBle_discoveryModeInfo.scanRspData) == CYBLE_ERROR_OK){
+        commitPending = 0u;
+        count(&committed);
+    }
+}
+
+/*******************************************************************
+* NAME :            void Beacon_WriteFrame(uint8 frame[])
+*
+* DESCRIPTION :     Pack the update counters for the advertisement,
+*                   big endian, saturated at 0xFFFF.
+*                   frame[0-1] Committed updates
+*                   frame[2-3] Skipped, data unchanged
+*                   frame[4-5] Deferred to the end of a radio event
+*                   frame[6]   TX power in dBm, signed
+*                   frame[7]   Scan requests in the stats window,
+*                              saturated at 0xFE, ADVFRAME_SCAN_REQ_NA
+*                              on builds without the event
+*/
+void Beacon_WriteFrame(uint8 frame[]){
+    frame[0] = (uint8)(committed >> 8);
+    frame[1] = (uint8)committed;
+    frame[2] = (uint8)(skipped >> 8);
+    frame[3] = (uint8)skipped;
+    frame[4] = (uint8)(deferred >> 8);
+    frame[5] = (uint8)deferred;
+    frame[6] = (uint8)Beacon_TxPowerDbm();
+#if (BEACON_SCAN_REQ_EVENTS)
+    frame[7] = (scanReqs > 0xFEu) ? 0xFEu : (uint8)scanReqs;
+#else
+    frame[7] = ADVFRAME_SCAN_REQ_NA;
+#endif
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,69 @@
+/* ========================================
+ * Air Quality Beacon, part of the hackAIR project.
+ * Freely available under CC BY 4.0
+ *
+ * Advertising control shared by all sensor firmwares. Advertising
+ * parameters can't change while advertising, so a new interval
+ * stops the advertisement and it is restarted with the custom
+ * interval from the stack event handler.
+ * New advertising data is compared against the data last handed to
+ * the link layer and only committed when it differs, between radio
+ * events. Committed, skipped and deferred updates are counted.
+ * The TX power is applied again on every start, the stack resets
+ * it to the component level when it restarts.
+ * Advertising is scannable so the scan response can carry the
+ * history, and scan requests tell whether anyone is listening.
+ * Units that don't need either can go back to non connectable
+ * advertising, which skips the receive window after each packet, by
+ * setting SETTINGS_FLAG_NON_SCANNABLE. Builds with the peripheral
+ * role ignore the flag and stay connectable for GATT.
+ *
+ * http://www.hackair.eu/
+*/
+#ifndef BEACON_H
+#define BEACON_H
+
+#include <project.h>
+
+/* Scan request events came with BLE component 3.x. The DN7C3CA006
+ * and GP2Y1010AU0F projects still use the 2.x stack library, which
+ * has neither the event nor CyBle_SetAppEventMask(). Those builds
+ * count no scan requests, report ADVFRAME_SCAN_REQ_NA instead, and
+ * the attended interval of AdvPolicy.h never applies. Broadcaster
+ * builds without the event default to non connectable advertising,
+ * peripheral builds stay connectable. */
+#ifdef CYBLE_EVT_GAP_SCAN_REQ_RECVD_MSK
+#define BEACON_SCAN_REQ_EVENTS          (1u)
+#else
+#define BEACON_SCAN_REQ_EVENTS          (0u)
+#endif
+
+/* The link layer delays each advertising event by 0-10ms at random,
+ * events are counted at the interval plus the mean delay. The page
+ * rotation waits for the rest of the delay and the event itself. */
+#define BEACON_ADV_DELAY_MS     (5u)
+#define BEACON_EVENT_GUARD_MS   (8u)
+
+void Beacon_StartAdvertising(void);
+void Beacon_SetInterval(uint16 newInterval);
+uint32 Beacon_IntervalMs(void);
+void Beacon_SetTxPower(uint8 level);
+int8 Beacon_TxPowerDbm(void);
+uint8 Beacon_Scannable(void);
+void Beacon_ScanRequest(uint32 now);
+uint16 Beacon_ScanQuietSecs(uint32 now);
+void Beacon_ResetWindow(void);
+void Beacon_AdvStartStop(void);
+void Beacon_Stopped(void);
+uint32 Beacon_Events(uint32 now);
+uint32 Beacon_TicksPastEvent(uint32 now);
+
+#define BEACON_FRAME_LEN    (8u)    // Bytes written by Beacon_WriteFrame()
+
+void Beacon_UpdateData(void);
+void Beacon_Commit(void);
+void Beacon_WriteFrame(uint8 frame[]);
+
+#endif /* BEACON_H */
+
+/* [] END OF FILE */
@@ -0,0 +1,54 @@
+/* ========================================
+ * Air Quality Beacon, part of the hackAIR project.
+ * Freely available under CC BY 4.0
+ *
+ * http://www.hackair.eu/
+*/
+#include "Cadence.h"
+
+static const CADENCE_CONFIG_T *cfg;
+static uint16 last;         // Previous reading
+static uint8 burstLeft;     // Quiet readings left in the current burst
+
+/*******************************************************************
+* NAME :            void Cadence_Init(const CADENCE_CONFIG_T *config)
+*
+* DESCRIPTION :     Start in a burst, so the first readings after
+*                   power up come in quickly
+*/
+void Cadence_Init(const CADENCE_CONFIG_T *config){
+    cfg = config;
+    last = 0u;
+    burstLeft = cfg->burstSamples;
+}
+
+/*******************************************************************
+* NAME :            uint32 Cadence_Update(uint16 value)
+*
+* DESCRIPTION :     Feed one reading
+* INPUTS :
+*       uint16 value    Reading in sensor units
+* OUTPUTS :
+*       uint32 Period until the next reading in ms
+*/
+uint32 Cadence_Update(uint16 value){
+    uint16 step = (value > last) ? (value - last) : (last - value);
+    
+    if((value >= cfg->levelThreshold) || (step >= cfg->rateThreshold)){
+        burstLeft = cfg->burstSamples; // Spike, (re)start the burst
+    }else if(burstLeft != 0u){
+        burstLeft--;
+    }
+    last = value;
+    return Cadence_PeriodMs();
+}
+
+uint32 Cadence_PeriodMs(void){
+    return (burstLeft != 0u) ? cfg->burstPeriodMs : cfg->slowPeriodMs;
+}
+
+uint8 Cadence_InBurst(void){
+    return (burstLeft != 0u) ? 1u : 0u;
+}
+
+/* [] END OF FILE */
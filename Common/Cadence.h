@@ -0,0 +1,43 @@
+/* ========================================
+ * Air Quality Beacon, part of the hackAIR project.
+ * Freely available under CC BY 4.0
+ *
+ * Measurement cadence controller shared by all sensor firmwares.
+ * Clean, stable air is sampled at the slow period. A reading above
+ * the level threshold, or a step between two readings above the
+ * rate threshold, starts a burst at the fast period that lasts for
+ * burstSamples quiet readings. No hardware access, the caller
+ * applies the returned period. Build with HACKAIR_HOST to use it
+ * on a PC.
+ *
+ * http://www.hackair.eu/
+*/
+#ifndef CADENCE_H
+#define CADENCE_H
+
+#ifdef HACKAIR_HOST
+#include <stdint.h>
+typedef uint8_t uint8;
+typedef uint16_t uint16;
+typedef uint32_t uint32;
+#else
+#include <cytypes.h>
+#endif
+
+typedef struct
+{
+    uint32 slowPeriodMs;    // Sampling period in stable air
+    uint32 burstPeriodMs;   // Sampling period during a burst
+    uint16 levelThreshold;  // Readings at or above this burst, in sensor units
+    uint16 rateThreshold;   // Step between two readings that bursts, in sensor units
+    uint8  burstSamples;    // Quiet readings before falling back to slow
+} CADENCE_CONFIG_T;
+
+void Cadence_Init(const CADENCE_CONFIG_T *config);
+uint32 Cadence_Update(uint16 value);
+uint32 Cadence_PeriodMs(void);
+uint8 Cadence_InBurst(void);
+
+#endif /* CADENCE_H */
+
+/* [] END OF FILE */
@@ -0,0 +1,48 @@
+/* ========================================
+ * Air Quality Beacon, part of the hackAIR project.
+ * Freely available under CC BY 4.0
+ *
+ * http://www.hackair.eu/
+*/
+#include "ClockMgr.h"
+#include "Settings.h"
+#include "LpTimer.h"
+#include "Energy.h"
+
+static uint8 current = CLOCKMGR_FAST;
+
+/*******************************************************************
+* NAME :            uint8 ClockMgr_Set(uint8 div)
+*
+* DESCRIPTION :     Switch the SYSCLK divider. Flash wait states are
+*                   raised before speeding up and lowered after
+*                   slowing down, CyDelay() and the CPU active
+*                   current of the energy model follow the new
+*                   frequency.
+* INPUTS :
+*       uint8 div       CLOCKMGR_FAST, CLOCKMGR_SLOW
+* OUTPUTS :
+*       uint8 Previous divider, to restore after a section
+*/
+uint8 ClockMgr_Set(uint8 div){
+    uint8 prev = current;
+    uint32 hz;
+    
+    if((SETTINGS_FLAGS & SETTINGS_FLAG_NOSCALE) != 0u) return prev;
+    if(div == current) return prev;
+    
+    hz = CYDEV_BCLK__HFCLK__HZ >> div;
+    if(div < current) CySysFlashSetWaitCycles(CYDEV_BCLK__HFCLK__MHZ);
+    CySysClkWriteSysclkDiv(div);
+    if(div > current) CySysFlashSetWaitCycles(hz / 1000000u);
+    CyDelayFreq(hz);
+    current = div;
+    Energy_ScaleLoad(ENERGY_CPU_ACTIVE, CLOCKMGR_ACTIVE_PERMILLE(div), LpTimer_Now());
+    return prev;
+}
+
+uint8 ClockMgr_Get(void){
+    return current;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,51 @@
+/* ========================================
+ * Air Quality Beacon, part of the hackAIR project.
+ * Freely available under CC BY 4.0
+ *
+ * SYSCLK scaling. HFCLK stays at the IMO frequency so the UART,
+ * ADC and PWM clocks, divided from HFCLK, never change. Only the
+ * CPU/bus clock is divided down, for the CPU sleep of a UART listen
+ * window, and brought back to full speed for everything that runs
+ * code.
+ *
+ * Energy per CPU cycle at each divider, from the energy model and
+ * the current table of the boards (6500uA active, 2300uA CPU sleep,
+ * both at 48MHz). The CPU sleep current is taken as the part that
+ * doesn't depend on SYSCLK: IMO, HFCLK tree, regulators. The rest of
+ * the active current is CPU, bus and flash switching and scales
+ * with SYSCLK. Charge per cycle is the active current over SYSCLK:
+ *
+ *   Divider   SYSCLK   Active    Per cycle   Per 10000 cycles
+ *   1         48MHz    6500uA    135pC       1.35uC
+ *   2         24MHz    4400uA    183pC       1.83uC
+ *   4         12MHz    3350uA    279pC       2.79uC
+ *   8         6MHz     2825uA    471pC       4.71uC   CLOCKMGR_SLOW
+ *
+ * Code run at the slow clock costs up to 3.5 times the charge, the
+ * floor runs 8 times longer for the same work, so bookkeeping stays
+ * at full speed. In CPU sleep the model draws the same 2300uA at any
+ * divider; the slow clock costs nothing there and saves whatever bus
+ * switching the sleep figure holds. CLOCKMGR_ACTIVE_PERMILLE() feeds
+ * the same model to the energy accounting. A bench measurement with
+ * and without SETTINGS_FLAG_NOSCALE is still the check of the split.
+ *
+ * http://www.hackair.eu/
+*/
+#ifndef CLOCKMGR_H
+#define CLOCKMGR_H
+
+#include <project.h>
+
+#define CLOCKMGR_FAST               (CY_SYS_CLK_SYSCLK_DIV1)
+#define CLOCKMGR_SLOW               (CY_SYS_CLK_SYSCLK_DIV8)    // 6MHz, still fast enough for UART ISRs
+
+/* CPU active current at a divider relative to full speed, see above */
+#define CLOCKMGR_FLOOR_PERMILLE     (354u)      // 2300uA of 6500uA
+#define CLOCKMGR_ACTIVE_PERMILLE(div)   (CLOCKMGR_FLOOR_PERMILLE + ((1000u - CLOCKMGR_FLOOR_PERMILLE) >> (div)))
+
+uint8 ClockMgr_Set(uint8 div);
+uint8 ClockMgr_Get(void);
+
+#endif /* CLOCKMGR_H */
+
+/* [] END OF FILE */
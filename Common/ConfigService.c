@@ -0,0 +1,165 @@
+/* ========================================
+ * Air Quality Beacon, part of the hackAIR project.
+ * Freely available under CC BY 4.0
+ *
+ * http://www.hackair.eu/
+*/
+#include "ConfigService.h"
+#include "Settings.h"
+#include "Beacon.h"
+#include "Energy.h"
+#include "LpTimer.h"
+
+#if (CONFIGSERVICE_ENABLED)
+
+static uint8 staged[SETTINGS_ROW_LEN]; // Row 0 image being edited
+static uint8 editing;       // staged holds changes
+static uint8 pending;       // Commit checked, waiting for ConfigService_Pump()
+static uint8 result = SETTINGS_OK;
+static uint8 window;
+
+/* Stage on top of the stored row */
+static void load(void){
+    uint16 i;
+    
+    for(i = 0u; i < SETTINGS_ROW_LEN; i++) staged[i] = SETTINGS_ROW[i];
+}
+
+/* Value for the next read */
+static void publish(void){
+    uint8 value[CONFIGSERVICE_VALUE_LEN];
+    uint16 seq = Settings_Sequence();
+    CYBLE_GATT_HANDLE_VALUE_PAIR_T pair;
+    uint8 i;
+    
+    if(!editing) load();
+    value[0] = SETTINGS_VERSION;
+    value[1] = (uint8)(seq & 0xFFu);
+    value[2] = (uint8)(seq >> 8);
+    value[3] = pending ? CONFIGSERVICE_BUSY : result;
+    value[4] = window;
+    for(i = 0u; i < CONFIGSERVICE_WINDOW_LEN; i++){
+        uint16 at = (uint16)window + i;
+        value[5u + i] = ((at < CONFIGSERVICE_KEY_START) || (at >= CONFIGSERVICE_KEY_END)) ? staged[at] : 0u; // The key stays secret
+    }
+    pair.attrHandle = CONFIGSERVICE_CHAR_HANDLE;
+    pair.value.val = value;
+    pair.value.len = CONFIGSERVICE_VALUE_LEN;
+    (void)CyBle_GattsWriteAttributeValue(&pair, 0u, NULL, CYBLE_GATT_DB_LOCALLY_INITIATED);
+}
+
+/* Run one command, SETTINGS_OK or the error */
+static uint8 command(const uint8 cmd[], uint16 len){
+    uint8 check;
+    uint16 i;
+    
+    switch((len > 0u) ? cmd[0] : 0xFFu){
+        case CONFIGSERVICE_CMD_WINDOW:
+            if(len != 2u) return CONFIGSERVICE_ERR_COMMAND;
+            if(cmd[1] > (SETTINGS_USED_LEN - CONFIGSERVICE_WINDOW_LEN)) return CONFIGSERVICE_ERR_OFFSET;
+            window = cmd[1];
+            return SETTINGS_OK;
+        case CONFIGSERVICE_CMD_STAGE:
+            if(len < 3u) return CONFIGSERVICE_ERR_COMMAND;
+            if(!CONFIGSERVICE_STAGEABLE((uint16)cmd[1], len - 2u)) return CONFIGSERVICE_ERR_OFFSET; // Flags, TX power, layout and key stay put
+            if(pending) return CONFIGSERVICE_ERR_STALE;
+            if(!editing) load();
+            editing = 1u;
+            for(i = 2u; i < len; i++) staged[cmd[1] + i - 2u] = cmd[i];
+            return SETTINGS_OK;
+        case CONFIGSERVICE_CMD_COMMIT:
+            if(len != 3u) return CONFIGSERVICE_ERR_COMMAND;
+            if(pending || ((uint16)(cmd[1] | ((uint16)cmd[2] << 8)) != Settings_Sequence())) return CONFIGSERVICE_ERR_STALE;
+            if(!editing) return SETTINGS_OK; // Nothing to write
+            check = Settings_Check(staged);
+            pending = (check == SETTINGS_OK) ? 1u : 0u;
+            return check;
+        case CONFIGSERVICE_CMD_DISCARD:
+            if(len != 1u) return CONFIGSERVICE_ERR_COMMAND;
+            if(pending) return CONFIGSERVICE_ERR_STALE;
+            editing = 0u;
+            return SETTINGS_OK;
+        default:
+            return CONFIGSERVICE_ERR_COMMAND;
+    }
+}
+
+#endif /* CONFIGSERVICE_ENABLED */
+
+/*******************************************************************
+* NAME :            void ConfigService_Init()
+*
+* DESCRIPTION :     Put the stored configuration in the GATT value.
+*                   Call once the BLE stack is on.
+*/
+void ConfigService_Init(void){
+#if (CONFIGSERVICE_ENABLED)
+    publish();
+#endif
+}
+
+#if (CYBLE_GAP_ROLE_PERIPHERAL)
+
+/*******************************************************************
+* NAME :            uint8 ConfigService_Write(CYBLE_GATTS_WRITE_REQ_PARAM_T *req)
+*
+* DESCRIPTION :     Call on CYBLE_EVT_GATTS_WRITE_REQ. A commit is
+*                   only checked here, the SFLASH write waits for
+*                   ConfigService_Pump() after the disconnect.
+* OUTPUTS :
+*       uint8 1 if the write was for this service and answered
+*/
+uint8 ConfigService_Write(CYBLE_GATTS_WRITE_REQ_PARAM_T *req){
+#if (CONFIGSERVICE_ENABLED)
+    if(req->handleValPair.attrHandle != CONFIGSERVICE_CHAR_HANDLE) return 0u;
+    result = command(req->handleValPair.value.val, req->handleValPair.value.len);
+    publish();
+    if(result == SETTINGS_OK){
+        (void)CyBle_GattsWriteRsp(req->connHandle);
+    }else{
+        CYBLE_GATTS_ERR_PARAM_T err;
+        
+        err.attrHandle = req->handleValPair.attrHandle;
+        err.opcode = CYBLE_GATT_WRITE_REQ;
+        err.errorCode = (CYBLE_GATT_ERR_CODE_T)(CONFIGSERVICE_ATT_ERR | result);
+        (void)CyBle_GattsErrorRsp(req->connHandle, &err);
+    }
+    return 1u;
+#else
+    (void)req;
+    return 0u;
+#endif
+}
+
+#endif /* CYBLE_GAP_ROLE_PERIPHERAL */
+
+/*******************************************************************
+* NAME :            uint8 ConfigService_Pump()
+*
+* DESCRIPTION :     Write a checked commit to SFLASH once the client
+*                   has disconnected. The BLE stack is stopped for
+*                   the row writes and restarted with the same event
+*                   handler, as Dormant_Enter() does. Call from the
+*                   main loop after CyBle_ProcessEvents().
+* OUTPUTS :
+*       uint8 1 if row 0 changed, the firmware applies it then
+*/
+uint8 ConfigService_Pump(void){
+#if (CONFIGSERVICE_ENABLED)
+    CYBLE_CALLBACK_T handler = CyBle_ApplCallback;
+    
+    if(!pending || (CyBle_GetState() == CYBLE_STATE_CONNECTED)) return 0u;
+    Beacon_Stopped();
+    CyBle_Stop(); // No link layer timing to keep during the SPC stalls
+    Energy_LoadOff(ENERGY_RADIO, LpTimer_Now());
+    result = Settings_Commit(staged);
+    pending = 0u;
+    editing = 0u;
+    CyBle_Start(handler); // CYBLE_EVT_STACK_ON publishes the result and restarts advertising
+    return (result == SETTINGS_OK) ? 1u : 0u;
+#else
+    return 0u;
+#endif
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,90 @@
+/* ========================================
+ * Air Quality Beacon, part of the hackAIR project.
+ * Freely available under CC BY 4.0
+ *
+ * GATT access to the unit configuration in SFLASH user row 0, see
+ * Settings.h for the parameters and the flags, AdvConfig.h and
+ * TxPower.h for the rest. Uses the third
+ * characteristic of the custom service in the BLE component,
+ * "Config": Read and Write, CONFIGSERVICE_VALUE_LEN bytes long,
+ * next to the peripheral role of HistoryService.h.
+ *
+ * Changes are staged in RAM, checked as a whole and written in one
+ * commit once the client disconnects, then applied without a reset.
+ * The result reads CONFIGSERVICE_BUSY until then, the next
+ * connection reads the outcome. The value read back:
+ *
+ *   [0]     SETTINGS_VERSION
+ *   [1-2]   Commit count of row 0, little endian
+ *   [3]     Result of the last command, SETTINGS_OK,
+ *           SETTINGS_ERR_* or CONFIGSERVICE_ERR_*
+ *   [4]     Window offset
+ *   [5-19]  Staged row from the window offset on, the row as
+ *           stored while nothing is staged. The tag key reads 0.
+ *
+ * Commands written, a failing one is also answered with the ATT
+ * error CONFIGSERVICE_ATT_ERR | result:
+ *
+ *   00 off             Move the window
+ *   01 off bytes...    Stage bytes at off, measurement parameters
+ *                      only
+ *   02 count(2)        Check and commit what is staged, if row 0
+ *                      still has this commit count
+ *   03                 Drop what is staged
+ *
+ * The characteristic is open to any central in range, so only the
+ * measurement parameters, bytes 2-15 of Settings.h, can be staged.
+ * The flags, the TX power levels, the advertising layout and the tag
+ * key are left to the programmer: a drive-by connection could
+ * otherwise replace the key, or advertise non connectable and lock
+ * every client out. No hardware access above the HACKAIR_HOST block.
+ *
+ * http://www.hackair.eu/
+*/
+#ifndef CONFIGSERVICE_H
+#define CONFIGSERVICE_H
+
+#define CONFIGSERVICE_VALUE_LEN     (20u)   // Fits the default MTU
+#define CONFIGSERVICE_WINDOW_LEN    (15u)
+#define CONFIGSERVICE_STAGE_START   (2u)    // Parameter block version
+#define CONFIGSERVICE_STAGE_END     (16u)   // After the advertising intervals
+#define CONFIGSERVICE_KEY_START     (48u)   // Tag key, reads 0
+#define CONFIGSERVICE_KEY_END       (64u)
+#define CONFIGSERVICE_ATT_ERR       (0x80u) // Application error codes
+
+/* Stage command for len bytes at off allowed */
+#define CONFIGSERVICE_STAGEABLE(off, len)   (((off) >= CONFIGSERVICE_STAGE_START) && (((off) + (len)) <= CONFIGSERVICE_STAGE_END))
+
+/* Commands */
+#define CONFIGSERVICE_CMD_WINDOW    (0x00u)
+#define CONFIGSERVICE_CMD_STAGE     (0x01u)
+#define CONFIGSERVICE_CMD_COMMIT    (0x02u)
+#define CONFIGSERVICE_CMD_DISCARD   (0x03u)
+
+/* Results next to the SETTINGS_* ones */
+#define CONFIGSERVICE_ERR_COMMAND   (0x10u) // Unknown command or bad length
+#define CONFIGSERVICE_ERR_OFFSET    (0x11u) // Outside the stageable bytes
+#define CONFIGSERVICE_ERR_STALE     (0x12u) // Row 0 changed since the client read it
+#define CONFIGSERVICE_BUSY          (0xFFu) // Commit waiting for the disconnect
+
+#ifndef HACKAIR_HOST
+#include <project.h>
+#include "BLE_custom.h"
+
+#if defined(CYBLE_CUSTOM_SERVICE_CONFIG_CHAR_HANDLE) && (CYBLE_GAP_ROLE_PERIPHERAL)
+#define CONFIGSERVICE_ENABLED       (1u)
+#define CONFIGSERVICE_CHAR_HANDLE   (CYBLE_CUSTOM_SERVICE_CONFIG_CHAR_HANDLE)
+#else
+#define CONFIGSERVICE_ENABLED       (0u)
+#endif
+
+void ConfigService_Init(void);
+#if (CYBLE_GAP_ROLE_PERIPHERAL)
+uint8 ConfigService_Write(CYBLE_GATTS_WRITE_REQ_PARAM_T *req);
+#endif
+uint8 ConfigService_Pump(void);
+#endif /* HACKAIR_HOST */
+
+#endif /* CONFIGSERVICE_H */
+
+/* [] END OF FILE */
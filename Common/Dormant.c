@@ -0,0 +1,86 @@
+/* ========================================
+ * Air Quality Beacon, part of the hackAIR project.
+ * Freely available under CC BY 4.0
+ *
+ * http://www.hackair.eu/
+*/
+#include "Dormant.h"
+#include "Beacon.h"
+#include "LpTimer.h"
+#include "PowerMgr.h"
+#include "Energy.h"
+#include "LedPattern.h"
+#include "ClockMgr.h"
+#include "Settings.h"
+#include "Supervisor.h"
+
+static uint32 wokeAt;
+static uint8 wakePending;
+static uint32 latency;      // LF ticks from the last wakeup to advertising
+
+uint8 Dormant_Enabled(void){
+    return ((SETTINGS_FLAGS & SETTINGS_FLAG_LONG_INTERVAL) != 0u) ? 1u : 0u;
+}
+
+/*******************************************************************
+* NAME :            uint32 Dormant_Enter(uint32 wake)
+*
+* DESCRIPTION :     Shut down the BLE stack and the LED, deep sleep
+*                   until the LF time wake and restart the stack with
+*                   the same event handler. Interrupts (supervisor,
+*                   pulse capture) are served on the way.
+* INPUTS :
+*       uint32 wake     Absolute LF time to wake up at
+* OUTPUTS :
+*       uint32 LF ticks spent asleep
+*/
+uint32 Dormant_Enter(uint32 wake){
+    CYBLE_CALLBACK_T handler = CyBle_ApplCallback;
+    uint32 slept = 0u;
+    
+    LedPattern_Enable(0u);
+    Beacon_Stopped();
+    CyBle_Stop(); // Also stops the ECO
+    Energy_LoadOff(ENERGY_RADIO, LpTimer_Now());
+    
+    while((int32)(wake - LpTimer_Now()) > 0){
+        slept += PowerMgr_Idle(wake, 1u);
+        Supervisor_Kick(); // Main loop is parked here until the wakeup
+    }
+    
+    ClockMgr_Set(CLOCKMGR_FAST);
+    wokeAt = LpTimer_Now();
+    wakePending = 1u;
+    CyBle_Start(handler); // CYBLE_EVT_STACK_ON restarts advertising
+    LedPattern_Enable(1u);
+    return slept;
+}
+
+/*******************************************************************
+* NAME :            void Dormant_Advertising(uint32 now)
+*
+* DESCRIPTION :     Call on CYBLE_EVT_GAPP_ADVERTISEMENT_START_STOP,
+*                   latches the wake to advertise latency once
+*                   advertising is up after a wakeup
+*/
+void Dormant_Advertising(uint32 now){
+    if((wakePending != 0u) && (CyBle_GetState() == CYBLE_STATE_ADVERTISING)){
+        wakePending = 0u;
+        latency = now - wokeAt;
+    }
+}
+
+/*******************************************************************
+* NAME :            uint8 Dormant_LatencyFrame()
+*
+* DESCRIPTION :     Latency of the last wakeup for the payload
+* OUTPUTS :
+*       uint8 DORMANT_LATENCY_UNIT_MS steps, saturated at 255
+*/
+uint8 Dormant_LatencyFrame(void){
+    uint32 ms = LpTimer_TicksToMs(latency) / DORMANT_LATENCY_UNIT_MS;
+    
+    return (ms > 0xFFu) ? 0xFFu : (uint8)ms;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,29 @@
+/* ========================================
+ * Air Quality Beacon, part of the hackAIR project.
+ * Freely available under CC BY 4.0
+ *
+ * Long interval mode for battery units that report every few
+ * minutes. Between reports the BLE stack is shut down completely
+ * and the CPU deep sleeps on the LF timer. Hibernate would stop the
+ * WDT and can only wake on a pin, and SRAM is kept in deep sleep,
+ * so no state has to be saved. On wakeup the stack is restarted
+ * right away and the time until advertising resumes is measured.
+ * Units select it with SETTINGS_FLAG_LONG_INTERVAL.
+ *
+ * http://www.hackair.eu/
+*/
+#ifndef DORMANT_H
+#define DORMANT_H
+
+#include <project.h>
+
+#define DORMANT_LATENCY_UNIT_MS (10u)   // Wake latency resolution in the frame
+
+uint8 Dormant_Enabled(void);
+uint32 Dormant_Enter(uint32 wake);
+void Dormant_Advertising(uint32 now);
+uint8 Dormant_LatencyFrame(void);
+
+#endif /* DORMANT_H */
+
+/* [] END OF FILE */
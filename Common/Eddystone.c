@@ -0,0 +1,107 @@
+/* ========================================
+ * Air Quality Beacon, part of the hackAIR project.
+ * Freely available under CC BY 4.0
+ *
+ * http://www.hackair.eu/
+*/
+#include "Eddystone.h"
+#include "Beacon.h"
+#include "LpTimer.h"
+#include "Settings.h"
+
+#define FLAGS_LEN           (3u)        // Flags AD kept in front of the frame
+#define PDUS_PER_EVENT      (3u)        // One per advertising channel
+
+#define UID_LEN             (28u)
+#define TLM_LEN             (22u)
+
+#define TEMP_NA             (0x8000u)   // 8.8 fixed point, "not supported"
+
+/* Complete list of 16 bit UUIDs, then the service data, up to the frame */
+#define SERVICE_HEADER(len) 0x03u, 0x03u, 0xAAu, 0xFEu, (len), 0x16u, 0xAAu, 0xFEu
+
+static uint8 uid[UID_LEN] = {
+    SERVICE_HEADER(0x17u),
+    0x00u,                          // Frame type UID
+    0u,                             // Power at 0m, follows the TX power
+    0x65u, 0xAAu, 0x7Fu, 0xB7u, 0xDDu, 0xBCu, 0xB8u, 0x85u, 0x8Eu, 0x1Eu, // Namespace
+    0u, 0u, 0u, 0u, 0u, 0u,         // Instance, from the unique ID
+    0u, 0u                          // Reserved
+};
+static uint8 tlm[TLM_LEN] = {
+    SERVICE_HEADER(0x11u),
+    0x20u,                          // Frame type TLM
+    0x00u                           // Unencrypted, version 0
+};
+static uint32 tenths;               // Uptime in 0.1s
+static uint32 tenthsSince;          // LF time tenths were counted up to
+static uint8 instanceSet;
+
+/* Big endian, as all Eddystone fields */
+static void putBe(uint8 *dst, uint32 value, uint8 len){
+    while(len > 0u){
+        len--;
+        dst[len] = (uint8)(value & 0xFFu);
+        value >>= 8;
+    }
+}
+
+/*******************************************************************
+* NAME :            uint8 Eddystone_Enabled()
+*
+* DESCRIPTION :     Eddystone pages selected for this unit
+*/
+uint8 Eddystone_Enabled(void){
+    return ((SETTINGS_FLAGS & SETTINGS_FLAG_EDDYSTONE) != 0u) ? 1u : 0u;
+}
+
+/*******************************************************************
+* NAME :            void Eddystone_Update(uint32 now)
+*
+* DESCRIPTION :     Encode both frames, once per measurement. The
+*                   pages only copy the result.
+*/
+void Eddystone_Update(uint32 now){
+    uint32 ticksPerTenth = LpTimer_TicksPerSec() / 10u;
+    uint32 n = (now - tenthsSince) / ticksPerTenth;
+    
+    if(!instanceSet){
+        uint32 id[2];
+        
+        CyGetUniqueId(id);
+        putBe(&uid[20], id[1] & 0xFFFFu, 2u);
+        putBe(&uid[22], id[0], 4u);
+        instanceSet = 1u;
+    }
+    
+    uid[9] = (uint8)(Beacon_TxPowerDbm() + EDDYSTONE_TX_0M);
+    tenths += n;
+    tenthsSince += n * ticksPerTenth;
+    
+    putBe(&tlm[10], 0u, 2u);            // VBATT, not supported
+    putBe(&tlm[12], TEMP_NA, 2u);
+    putBe(&tlm[14], Beacon_Events(now) * PDUS_PER_EVENT, 4u);
+    putBe(&tlm[18], tenths, 4u);
+}
+
+/*******************************************************************
+* NAME :            uint8 Eddystone_Write(uint8 page, uint8 adv[])
+*
+* DESCRIPTION :     Put a frame encoded by Eddystone_Update() after
+*                   the flags
+* INPUTS :
+*       uint8 page      EDDYSTONE_PAGE_UID or EDDYSTONE_PAGE_TLM
+*       uint8 adv[]     Advertising data
+* OUTPUTS :
+*       uint8 Advertising data length
+*/
+uint8 Eddystone_Write(uint8 page, uint8 adv[]){
+    const uint8 *frame = (page == EDDYSTONE_PAGE_UID) ? uid : tlm;
+    uint8 len = (page == EDDYSTONE_PAGE_UID) ? UID_LEN : TLM_LEN;
+    uint8 i;
+    
+    for(i = 0u; i < len; i++) adv[FLAGS_LEN + i] = frame[i];
+    return FLAGS_LEN + len;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,41 @@
+/* ========================================
+ * Air Quality Beacon, part of the hackAIR project.
+ * Freely available under CC BY 4.0
+ *
+ * Eddystone-UID and Eddystone-TLM frames, so stock beacon apps and
+ * gateways can find and monitor units without knowing the hackAIR
+ * frame. Shared by all sensor firmwares. Both frames are encoded
+ * once per measurement and go out as two more advertising pages
+ * between the hackAIR frames, see AdvPages.h, on units with
+ * SETTINGS_FLAG_EDDYSTONE. They replace the name and the frame, the
+ * flags are kept.
+ *
+ * UID: namespace is the first 10 bytes of SHA-1("hackair.eu"),
+ * instance the low 6 bytes of the silicon unique ID.
+ * TLM: this hardware measures neither its supply nor its
+ * temperature, VBATT and TEMP carry the Eddystone "not supported"
+ * values. ADV_CNT is estimated from the time spent advertising at
+ * each interval, SEC_CNT is the LF time since power up.
+ *
+ * http://www.hackair.eu/
+*/
+#ifndef EDDYSTONE_H
+#define EDDYSTONE_H
+
+#include <project.h>
+
+/* Calibrated power at 0m relative to the TX power: RSSI at 1m
+ * plus 41dB, at 0dBm */
+#define EDDYSTONE_TX_0M         (-18)
+
+/* Pages for AdvPages, after the hackAIR frame types */
+#define EDDYSTONE_PAGE_UID      (6u)
+#define EDDYSTONE_PAGE_TLM      (7u)
+
+uint8 Eddystone_Enabled(void);
+void Eddystone_Update(uint32 now);
+uint8 Eddystone_Write(uint8 page, uint8 adv[]);
+
+#endif /* EDDYSTONE_H */
+
+/* [] END OF FILE */
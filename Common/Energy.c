@@ -0,0 +1,168 @@
+/* ========================================
+ * Air Quality Beacon, part of the hackAIR project.
+ * Freely available under CC BY 4.0
+ *
+ * http://www.hackair.eu/
+*/
+#include "Energy.h"
+
+#define SEC_PER_HOUR        (3600u)
+
+static const uint32 *table;         // uA per state as configured
+static uint32 current[ENERGY_STATES]; // uA per state after scaling
+static uint8 cpuState;
+static uint8 loadsOn;               // Bit per load state
+static uint32 since[ENERGY_STATES]; // Start of the running interval
+static uint32 residency[ENERGY_STATES]; // Ticks in the current window
+static uint32 windowStart;
+static uint64 charge;               // uA * ticks since Energy_Start()
+static uint32 ticksPerSec = 32768u; // LFCLK rate, WCO unless told otherwise
+
+#define isOn(s)     (((s) <= ENERGY_CPU_DEEPSLEEP) ? ((s) == cpuState) : ((loadsOn & (1u << (s))) != 0u))
+
+/* Close the running interval of a state at now */
+static void account(uint8 s, uint32 now){
+    uint32 dt = now - since[s];
+    
+    residency[s] += dt;
+    charge += (uint64)dt * current[s];
+    since[s] = now;
+}
+
+/* Bring every running state up to now before reading counters */
+static void update(uint32 now){
+    uint8 s;
+    
+    for(s = 0u; s < ENERGY_STATES; s++){
+        if(isOn(s)) account(s, now);
+    }
+}
+
+/*******************************************************************
+* NAME :            void Energy_Start(config, now)
+*
+* DESCRIPTION :     Start accounting with the CPU active and all
+*                   loads off
+* INPUTS :
+*       const uint32 config[]   Current per state in uA
+*/
+void Energy_Start(const uint32 config[ENERGY_STATES], uint32 now){
+    uint8 s;
+    
+    for(s = 0u; s < ENERGY_STATES; s++) current[s] = config[s];
+    table = config;
+    cpuState = ENERGY_CPU_ACTIVE;
+    loadsOn = 0u;
+    charge = 0u;
+    since[ENERGY_CPU_ACTIVE] = now;
+    Energy_ResetWindow(now);
+}
+
+void Energy_SetCpu(uint8 state, uint32 now){
+    if((table == 0) || (state == cpuState) || (state > ENERGY_CPU_DEEPSLEEP)) return;
+    account(cpuState, now);
+    cpuState = state;
+    since[state] = now;
+}
+
+void Energy_LoadOn(uint8 load, uint32 now){
+    if((table == 0) || (load <= ENERGY_CPU_DEEPSLEEP) || (load >= ENERGY_STATES) || isOn(load)) return;
+    loadsOn |= (uint8)(1u << load);
+    since[load] = now;
+}
+
+void Energy_LoadOff(uint8 load, uint32 now){
+    if((table == 0) || (load <= ENERGY_CPU_DEEPSLEEP) || (load >= ENERGY_STATES) || !isOn(load)) return;
+    account(load, now);
+    loadsOn &= (uint8)~(1u << load);
+}
+
+/*******************************************************************
+* NAME :            void Energy_ScaleLoad(uint8 state, uint16 permille, uint32 now)
+*
+* DESCRIPTION :     Scale the configured current of a state, for
+*                   loads whose average depends on a rate
+*/
+void Energy_ScaleLoad(uint8 state, uint16 permille, uint32 now){
+    if((table == 0) || (state >= ENERGY_STATES)) return;
+    if(isOn(state)) account(state, now);
+    current[state] = (table[state] * permille) / 1000u;
+}
+
+/*******************************************************************
+* NAME :            uint16 Energy_ResidencyPermille(uint8 state, uint32 now)
+*
+* DESCRIPTION :     Share of the current window spent in a state
+* OUTPUTS :
+*       uint16 Residency in 0.1% steps
+*/
+uint16 Energy_ResidencyPermille(uint8 state, uint32 now){
+    uint32 total = now - windowStart;
+    uint32 t;
+    
+    if((table == 0) || (state >= ENERGY_STATES) || (total == 0u)) return 0u;
+    update(now);
+    t = residency[state];
+    if(total > (0xFFFFFFFFu / 1000u)){ // Keep the product in 32 bits
+        t >>= 10;
+        total >>= 10;
+    }
+    return (uint16)((t * 1000u) / total);
+}
+
+/*******************************************************************
+* NAME :            uint32 Energy_ChargeUAh(uint32 now)
+*
+* DESCRIPTION :     Estimated charge drawn since Energy_Start()
+* OUTPUTS :
+*       uint32 Charge in uAh
+*/
+uint32 Energy_ChargeUAh(uint32 now){
+    if(table == 0) return 0u;
+    update(now);
+    return (uint32)(charge / ((uint64)ticksPerSec * SEC_PER_HOUR));
+}
+
+/*******************************************************************
+* NAME :            void Energy_SetTickRate(uint32 rate)
+*
+* DESCRIPTION :     LFCLK rate used to turn accumulated ticks into
+*                   charge. Follows the ILO calibration on boards
+*                   without a watch crystal.
+*/
+void Energy_SetTickRate(uint32 rate){
+    if(rate != 0u) ticksPerSec = rate;
+}
+
+void Energy_ResetWindow(uint32 now){
+    uint8 s;
+    
+    update(now);
+    for(s = 0u; s < ENERGY_STATES; s++) residency[s] = 0u;
+    windowStart = now;
+}
+
+/*******************************************************************
+* NAME :            void Energy_WriteFrame(uint8 frame[], uint32 now)
+*
+* DESCRIPTION :     Pack the energy counters for the advertisement.
+*                   Residencies are in 0.5% steps (0-200), deep sleep
+*                   is whatever is left of active and sleep.
+*                   frame[0] CPU active     frame[3] LED
+*                   frame[1] CPU sleep      frame[4] ADC/UART
+*                   frame[2] Sensor         frame[5-6] Charge, 0.1mAh
+*/
+void Energy_WriteFrame(uint8 frame[], uint32 now){
+    static const uint8 order[5] = {ENERGY_CPU_ACTIVE, ENERGY_CPU_SLEEP, ENERGY_SENSOR, ENERGY_LED, ENERGY_PERIPH};
+    uint32 tenths = Energy_ChargeUAh(now) / 100u;
+    uint8 i;
+    
+    for(i = 0u; i < 5u; i++){
+        frame[i] = (uint8)((Energy_ResidencyPermille(order[i], now) + 2u) / 5u);
+    }
+    if(tenths > 0xFFFFu) tenths = 0xFFFFu;
+    frame[5] = (uint8)(tenths >> 8);
+    frame[6] = (uint8)(tenths & 0xFFu);
+}
+
+/* [] END OF FILE */
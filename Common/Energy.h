@@ -0,0 +1,57 @@
+/* ========================================
+ * Air Quality Beacon, part of the hackAIR project.
+ * Freely available under CC BY 4.0
+ *
+ * Energy accounting shared by all sensor firmwares.
+ * Every power state change is timestamped with the LF timer. The
+ * CPU is always in exactly one of active/sleep/deep sleep, the
+ * other states are loads that add their current on top. Residency
+ * is kept per stats window, charge is accumulated since start from
+ * a per board current table. Like the scheduler this file has no
+ * hardware access, time is passed in by the caller, build with
+ * HACKAIR_HOST to use it on a PC.
+ *
+ * http://www.hackair.eu/
+*/
+#ifndef ENERGY_H
+#define ENERGY_H
+
+#ifdef HACKAIR_HOST
+#include <stdint.h>
+typedef uint8_t uint8;
+typedef uint16_t uint16;
+typedef uint32_t uint32;
+typedef uint64_t uint64;
+#else
+#include <cytypes.h>
+#endif
+
+/* CPU states, mutually exclusive */
+#define ENERGY_CPU_ACTIVE       (0u)
+#define ENERGY_CPU_SLEEP        (1u)
+#define ENERGY_CPU_DEEPSLEEP    (2u)
+/* Loads, any combination */
+#define ENERGY_SENSOR           (3u)    // Sensor supply (fan, heater, laser, emitter)
+#define ENERGY_LED              (4u)    // Status LED
+#define ENERGY_PERIPH           (5u)    // ADC or UART running
+#define ENERGY_RADIO            (6u)    // Advertising, average current per interval
+#define ENERGY_STATES           (7u)
+
+#define ENERGY_FRAME_LEN        (7u)    // Bytes written by Energy_WriteFrame()
+
+/* uA per state, indexed by the defines above */
+void Energy_Start(const uint32 config[ENERGY_STATES], uint32 now);
+void Energy_SetCpu(uint8 state, uint32 now);
+void Energy_LoadOn(uint8 load, uint32 now);
+void Energy_LoadOff(uint8 load, uint32 now);
+void Energy_ScaleLoad(uint8 state, uint16 permille, uint32 now);
+
+uint16 Energy_ResidencyPermille(uint8 state, uint32 now);
+uint32 Energy_ChargeUAh(uint32 now);
+void Energy_SetTickRate(uint32 rate);
+void Energy_ResetWindow(uint32 now);
+void Energy_WriteFrame(uint8 frame[], uint32 now);
+
+#endif /* ENERGY_H */
+
+/* [] END OF FILE */
@@ -0,0 +1,126 @@
+/* ========================================
+ * Air Quality Beacon, part of the hackAIR project.
+ * Freely available under CC BY 4.0
+ *
+ * http://www.hackair.eu/
+*/
+#include "History.h"
+#include "AdvFrame.h"
+#include "LpTimer.h"
+
+#define FIELD_WIDE      (0x80u)     // Bit 7 of the first byte: 2 byte field
+
+static int16 newest;                // Newest reading
+static uint32 newestAt;             // LpTimer_Now() of the newest reading
+static uint8 readings;              // Readings covered, newest included
+static uint8 deltas[HISTORY_DELTA_LEN]; // Encoded older readings, newest first
+static uint8 deltaLen;
+static uint8 written;               // Scan response length last written, 0 if stale
+
+/* One 7 bit or 15 bit field, returns the bytes written */
+static uint8 putField(uint8 p[], int32 v, uint8 narrow){
+    if(narrow){
+        p[0] = (uint8)(v & 0x7F);
+        return 1u;
+    }
+    p[0] = (uint8)(FIELD_WIDE | ((v >> 8) & 0x7F));
+    p[1] = (uint8)v;
+    return 2u;
+}
+
+/* Offset of the oldest reading in deltas[] */
+static uint8 oldestPair(void){
+    uint8 i = 0u;
+    uint8 last = 0u;
+    
+    while(i < deltaLen){
+        last = i;
+        i += (deltas[i] & FIELD_WIDE) ? 2u : 1u; // Seconds
+        i += (deltas[i] & FIELD_WIDE) ? 2u : 1u; // Difference
+    }
+    return last;
+}
+
+/*******************************************************************
+* NAME :            void History_Add(int16 value, uint32 now)
+*
+* DESCRIPTION :     Make value the newest reading. The previous
+*                   newest is encoded in front of the older ones,
+*                   the oldest drop out to make room. A step too
+*                   large for 15 bits restarts the history. A
+*                   repeat of the newest reading changes nothing.
+* INPUTS :
+*       int16 value         Reading in sensor units
+*       uint32 now          LpTimer_Now() of the reading
+*/
+void History_Add(int16 value, uint32 now){
+    if((readings != 0u) && (value == newest)) return;
+    if(readings != 0u){
+        uint32 secs = (now - newestAt) / LpTimer_TicksPerSec();
+        int32 diff = (int32)value - newest;
+        
+        if((diff < -0x4000) || (diff > 0x3FFF)){
+            readings = 0u;
+            deltaLen = 0u;
+        }else{
+            uint8 pair[4];
+            uint8 n;
+            uint8 i;
+            
+            if(secs > 0x7FFFu) secs = 0x7FFFu;
+            n = putField(pair, (int32)secs, secs <= 0x7Fu);
+            n += putField(&pair[n], diff, (diff >= -0x40) && (diff <= 0x3F));
+            while((deltaLen + n) > HISTORY_DELTA_LEN){
+                deltaLen = oldestPair();
+                readings--;
+            }
+            for(i = deltaLen; i > 0u; i--) deltas[i - 1u + n] = deltas[i - 1u];
+            for(i = 0u; i < n; i++) deltas[i] = pair[i];
+            deltaLen += n;
+        }
+    }
+    newest = value;
+    newestAt = now;
+    if(readings < 0xFFu) readings++;
+    written = 0u;
+}
+
+/*******************************************************************
+* NAME :            uint8 History_Write(uint8 rsp[], uint8 sensor, uint32 now)
+*
+* DESCRIPTION :     Write the history structure for the scan
+*                   response, see History.h for the layout. Without
+*                   a new reading since the last call only the age
+*                   of the newest reading is brought up to now, call
+*                   once per advertising page to keep it current.
+* INPUTS :
+*       uint8 rsp[]         Scan response data
+*       uint8 sensor        ADVFRAME_SENSOR_*
+*       uint32 now          LpTimer_Now()
+* OUTPUTS :
+*       uint8 Scan response data length to use, 0 before the
+*             first reading
+*/
+uint8 History_Write(uint8 rsp[], uint8 sensor, uint32 now){
+    uint32 age = (now - newestAt) / LpTimer_TicksPerSec();
+    uint8 i;
+    
+    if(readings == 0u) return 0u;
+    if(written == 0u){
+        rsp[0] = (uint8)(HISTORY_HEADER_LEN - 1u + deltaLen);
+        rsp[1] = ADVFRAME_AD_TYPE;
+        rsp[2] = (uint8)(AdvFrame_Company() & 0xFFu);
+        rsp[3] = (uint8)(AdvFrame_Company() >> 8);
+        rsp[4] = (uint8)((ADVFRAME_VERSION << 4) | ADVFRAME_TYPE_HISTORY);
+        rsp[5] = sensor;
+        rsp[6] = readings;
+        rsp[8] = (uint8)((uint16)newest >> 8);
+        rsp[9] = (uint8)newest;
+        for(i = 0u; i < deltaLen; i++) rsp[HISTORY_HEADER_LEN + i] = deltas[i];
+        written = (uint8)(HISTORY_HEADER_LEN + deltaLen);
+    }
+    rsp[7] = (age > 0xFFu) ? 0xFFu : (uint8)age;
+    return written;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,47 @@
+/* ========================================
+ * Air Quality Beacon, part of the hackAIR project.
+ * Freely available under CC BY 4.0
+ *
+ * Reading history for the scan response, shared by all sensor
+ * firmwares. A scanner that catches one advertising event in ten
+ * still gets the series in between. The scan response holds one
+ * manufacturer specific data structure:
+ *
+ *   [0-3]   AD length, 0xFF, company ID as in AdvFrame.h
+ *   [4]     Format version (high nibble), ADVFRAME_TYPE_HISTORY
+ *   [5]     Sensor type
+ *   [6]     Readings in the structure, newest included
+ *   [7]     Age of the newest reading in seconds, refreshed with
+ *           every advertising page, saturated
+ *   [8-9]   Newest reading, big endian
+ *   [10-]   Per older reading, newest first: seconds to the next
+ *           newer reading, then the next newer reading minus this
+ *           one. Both are 1 byte (bit 7 clear, 7 bit value) or
+ *           2 bytes big endian (bit 15 set, 15 bit value). The
+ *           difference is two's complement in its 7 or 15 bits.
+ *
+ * Readings are in sensor units: PM2.5 in ug/m^3 for the laser
+ * sensors, mV for DN7C3CA006/GP2Y1010AU0F, pcs/0.01cf for PPD42.
+ * The deltas are kept encoded and extended as readings arrive, the
+ * oldest readings drop out when the structure is full. Repeated
+ * readings fold into the first one, the value holds until the next
+ * reading that differs, so a steady sensor leaves the scan response
+ * untouched.
+ *
+ * http://www.hackair.eu/
+*/
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <project.h>
+
+#define HISTORY_HEADER_LEN      (10u)
+#define HISTORY_DELTA_LEN       (CYBLE_GAP_MAX_SCAN_RSP_DATA_LEN - HISTORY_HEADER_LEN)
+#define HISTORY_VALUE_MAX       (32767)     // Largest reading, unsigned sensor values saturate here
+
+void History_Add(int16 value, uint32 now);
+uint8 History_Write(uint8 rsp[], uint8 sensor, uint32 now);
+
+#endif /* HISTORY_H */
+
+/* [] END OF FILE */
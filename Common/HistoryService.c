@@ -0,0 +1,235 @@
+/* ========================================
+ * Air Quality Beacon, part of the hackAIR project.
+ * Freely available under CC BY 4.0
+ *
+ * http://www.hackair.eu/
+*/
+#include "HistoryService.h"
+#include "Logbook.h"
+#include "LpTimer.h"
+
+#if (CYBLE_GAP_ROLE_PERIPHERAL)
+
+#define PAYLOAD_MAX     (CYBLE_GATT_MTU - HISTORYSERVICE_ATT_HDR)
+
+static LOGBOOK_RECORD_T records[HISTORYSERVICE_RECORDS];
+static uint8 packet[PAYLOAD_MAX];   // Off the 2 KB stack, shared with LiveStream_Pump()
+static uint8 notify;        // Client enabled notifications
+static uint8 active;        // Transfer running
+static uint8 fast;          // Short connection interval granted or requested
+static uint16 mtu = CYBLE_GATT_DEFAULT_MTU;
+static uint32 next;         // Next record to send, kept for HISTORYSERVICE_RESUME
+static uint32 nextAge;      // Its age in seconds at ageAt
+static uint32 ageAt;
+static uint32 sentRecords;  // Summary of the running transfer
+static uint16 sentNtf;
+static uint32 startedAt;
+
+/* Big endian */
+static void putBe(uint8 *dst, uint32 value, uint8 len){
+    while(len > 0u){
+        len--;
+        dst[len] = (uint8)(value & 0xFFu);
+        value >>= 8;
+    }
+}
+
+/* Continue at seq, or at the oldest record kept */
+static void seek(uint32 seq, uint32 now){
+    if(seq < Logbook_First()) seq = Logbook_First();
+    if(seq > Logbook_End()) seq = Logbook_End();
+    next = seq;
+    nextAge = Logbook_AgeSecs(seq, now);
+    ageAt = now;
+}
+
+/* Notification from next on, return its length and the records in it */
+static uint16 build(uint8 pkt[], uint8 *count, uint32 now){
+    uint32 age = nextAge + ((now - ageAt) / LpTimer_TicksPerSec());
+    uint16 max = mtu - HISTORYSERVICE_ATT_HDR;
+    uint16 len = HISTORYSERVICE_HEADER_LEN;
+    const LOGBOOK_RECORD_T *rec;
+    
+    putBe(pkt, next, 4u);
+    putBe(&pkt[4], age, 4u);
+    *count = 0u;
+    while(((len + HISTORYSERVICE_RECORD_LEN) <= max) && ((rec = Logbook_Get(next + *count)) != 0)){
+        putBe(&pkt[len], (uint16)rec->value, 2u);
+        putBe(&pkt[len + 2u], rec->gap, 2u);
+        len += HISTORYSERVICE_RECORD_LEN;
+        (*count)++;
+    }
+    return len;
+}
+
+/* Closing notification, the header followed by the summary */
+static uint16 summary(uint8 pkt[], uint32 now){
+    putBe(&pkt[4], HISTORYSERVICE_AGE_END, 4u);
+    putBe(&pkt[8], sentRecords, 4u);
+    putBe(&pkt[12], sentNtf, 2u);
+    putBe(&pkt[14], LpTimer_TicksToMs(now - startedAt), 4u);
+    putBe(&pkt[18], mtu, 2u);
+    return HISTORYSERVICE_HEADER_LEN + HISTORYSERVICE_SUMMARY_LEN;
+}
+
+/* Ask the central for short connection intervals while records go out */
+static void setInterval(uint8 wantFast){
+    CYBLE_GAP_CONN_UPDATE_PARAM_T param;
+    
+    if(wantFast == fast) return;
+    if(wantFast){
+        param.connIntvMin = HISTORYSERVICE_FAST_INTV_MIN;
+        param.connIntvMax = HISTORYSERVICE_FAST_INTV_MAX;
+        param.connLatency = 0u;
+        param.supervisionTO = HISTORYSERVICE_FAST_TIMEOUT;
+    }else{
+        param.connIntvMin = HISTORYSERVICE_IDLE_INTV_MIN;
+        param.connIntvMax = HISTORYSERVICE_IDLE_INTV_MAX;
+        param.connLatency = HISTORYSERVICE_IDLE_LATENCY;
+        param.supervisionTO = HISTORYSERVICE_IDLE_TIMEOUT;
+    }
+    if(CyBle_L2capLeConnectionParamUpdateRequest(cyBle_connHandle.bdHandle, &param) == CYBLE_ERROR_OK){
+        fast = wantFast; // Else retried on the next pass
+    }
+}
+
+/* Move past the records sent, the age follows the gaps */
+static void advance(uint8 count){
+    while(count > 0u){
+        const LOGBOOK_RECORD_T *newer;
+        
+        next++;
+        newer = Logbook_Get(next);
+        if(newer != 0) nextAge = (newer->gap < nextAge) ? (nextAge - newer->gap) : 0u;
+        count--;
+    }
+}
+
+/*******************************************************************
+* NAME :            uint8 HistoryService_Write(CYBLE_GATTS_WRITE_REQ_PARAM_T *req)
+*
+* DESCRIPTION :     Call on CYBLE_EVT_GATTS_WRITE_REQ
+* OUTPUTS :
+*       uint8 1 if the write was for this service and answered
+*/
+uint8 HistoryService_Write(CYBLE_GATTS_WRITE_REQ_PARAM_T *req){
+    CYBLE_GATT_VALUE_T *value = &req->handleValPair.value;
+    
+    if(req->handleValPair.attrHandle == HISTORYSERVICE_CCCD_HANDLE){
+        notify = ((value->len > 0u) && ((value->val[0] & 0x01u) != 0u)) ? 1u : 0u;
+        (void)CyBle_GattsWriteAttributeValue(&req->handleValPair, 0u, &req->connHandle, CYBLE_GATT_DB_PEER_INITIATED);
+    }else if(req->handleValPair.attrHandle == HISTORYSERVICE_CHAR_HANDLE){
+        if(value->len == 4u){
+            uint32 seq = ((uint32)value->val[0] << 24) | ((uint32)value->val[1] << 16) |
+                         ((uint32)value->val[2] << 8) | value->val[3];
+            
+            seek((seq == HISTORYSERVICE_RESUME) ? next : seq, LpTimer_Now());
+            active = 1u;
+            sentRecords = 0u;
+            sentNtf = 0u;
+            startedAt = ageAt;
+        }else if(value->len == 0u){
+            active = 0u;
+        }else{
+            CYBLE_GATTS_ERR_PARAM_T err;
+            
+            err.attrHandle = req->handleValPair.attrHandle;
+            err.opcode = CYBLE_GATT_WRITE_REQ;
+            err.errorCode = CYBLE_GATT_ERR_INVALID_ATTRIBUTE_LEN;
+            (void)CyBle_GattsErrorRsp(req->connHandle, &err);
+            return 1u;
+        }
+    }else{
+        return 0u;
+    }
+    (void)CyBle_GattsWriteRsp(req->connHandle);
+    return 1u;
+}
+
+/*******************************************************************
+* NAME :            void HistoryService_MtuExchanged(const CYBLE_GATT_XCHG_MTU_PARAM_T *param)
+*
+* DESCRIPTION :     Call on CYBLE_EVT_GATTS_XCNHG_MTU_REQ. The BLE
+*                   component answers with CYBLE_GATT_MTU, the
+*                   smaller of the two is in use from then on.
+*/
+void HistoryService_MtuExchanged(const CYBLE_GATT_XCHG_MTU_PARAM_T *param){
+    mtu = (param->mtu < CYBLE_GATT_MTU) ? param->mtu : CYBLE_GATT_MTU;
+    if(mtu < CYBLE_GATT_DEFAULT_MTU) mtu = CYBLE_GATT_DEFAULT_MTU;
+}
+
+/*******************************************************************
+* NAME :            void HistoryService_Disconnected()
+*
+* DESCRIPTION :     Call on CYBLE_EVT_GAP_DEVICE_DISCONNECTED. The
+*                   position is kept for HISTORYSERVICE_RESUME.
+*/
+void HistoryService_Disconnected(void){
+    notify = 0u;
+    active = 0u;
+    fast = 0u;
+    mtu = CYBLE_GATT_DEFAULT_MTU;
+}
+
+/*******************************************************************
+* NAME :            uint8 *HistoryService_Packet()
+*
+* DESCRIPTION :     Notification buffer of PAYLOAD_MAX bytes for the
+*                   pumps of the main loop. The stack copies a
+*                   notification when it is queued, so the buffer is
+*                   free again once a pump returns.
+*/
+uint8 *HistoryService_Packet(void){
+    return packet;
+}
+
+#endif /* CYBLE_GAP_ROLE_PERIPHERAL */
+
+/*******************************************************************
+* NAME :            void HistoryService_Init()
+*
+* DESCRIPTION :     Start logging, only with the peripheral role
+*/
+void HistoryService_Init(void){
+#if (CYBLE_GAP_ROLE_PERIPHERAL)
+    Logbook_Init(records, HISTORYSERVICE_RECORDS);
+#endif
+}
+
+void HistoryService_Add(int16 value, uint32 now){
+    Logbook_Add(value, now);
+}
+
+/*******************************************************************
+* NAME :            void HistoryService_Pump()
+*
+* DESCRIPTION :     Queue notifications until the stack is busy or
+*                   the client is up to date, and keep the
+*                   connection interval short meanwhile. Call from
+*                   the main loop after CyBle_ProcessEvents().
+*/
+void HistoryService_Pump(void){
+#if (CYBLE_GAP_ROLE_PERIPHERAL)
+    if(CyBle_GetState() != CYBLE_STATE_CONNECTED) return;
+    setInterval((active && notify) ? 1u : 0u);
+    while(active && notify && (CyBle_GattGetBusStatus() == CYBLE_STACK_STATE_FREE)){
+        uint8 *pkt = packet;
+        uint8 count;
+        CYBLE_GATTS_HANDLE_VALUE_NTF_T ntf;
+        uint32 now = LpTimer_Now();
+        
+        if(next < Logbook_First()) seek(next, now); // Overwritten while waiting
+        ntf.attrHandle = HISTORYSERVICE_CHAR_HANDLE;
+        ntf.value.val = pkt;
+        ntf.value.len = build(pkt, &count, now);
+        if(count == 0u) ntf.value.len = summary(pkt, now);
+        if(CyBle_GattsNotification(cyBle_connHandle, &ntf) != CYBLE_ERROR_OK) break; // Retry on the next pass
+        advance(count);
+        sentRecords += count;
+        if(count != 0u) sentNtf++;
+        else active = 0u; // Up to date
+    }
+#endif
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,98 @@
+/* ========================================
+ * Air Quality Beacon, part of the hackAIR project.
+ * Freely available under CC BY 4.0
+ *
+ * GATT bulk download of the Logbook, shared by all sensor
+ * firmwares. The BLE component of every design is in the
+ * Peripheral and Broadcaster GAP role, its Custom Service carrying
+ * the History characteristic: Write and Notify, with a Client
+ * Characteristic Configuration descriptor. Set back to Broadcaster
+ * only, everything here compiles to nothing and units keep
+ * advertising only.
+ *
+ * A client enables notifications and writes the sequence number
+ * to start from, big endian. HISTORYSERVICE_RESUME continues after
+ * the last record sent, also across a disconnect. An empty write
+ * stops the transfer. Records are then notified back to back, as
+ * many queued as the stack takes, each notification:
+ *
+ *   [0-3]   Sequence number of the first record, big endian. A
+ *           jump means the requested records were overwritten.
+ *   [4-7]   Age of the first record in seconds, big endian
+ *   [8-]    Records: reading, then seconds since the previous
+ *           record, both 16 bit big endian
+ *
+ * Notifications fill the ATT MTU negotiated with the client. The
+ * default 23 byte MTU leaves room for 3 records per notification,
+ * 11 bytes of ATT and history headers for 12 bytes of records. The
+ * BLE component has its MTU set to HISTORYSERVICE_MTU, a client
+ * exchanging that MTU gets 59 records for the same 11 bytes. While
+ * records are going out the unit asks the central for the shortest
+ * connection interval, and for a relaxed one again once idle.
+ *
+ * The transfer ends with a notification without records, its age
+ * set to HISTORYSERVICE_AGE_END and a summary after the header:
+ *
+ *   [8-11]  Records sent
+ *   [12-13] Notifications sent, without this one
+ *   [14-17] Milliseconds from the start to this notification
+ *   [18-19] ATT MTU in use
+ *
+ * Throughput and overhead follow from these, Tools/histclient.c
+ * prints them from a log of the notifications. No hardware access
+ * above the HACKAIR_HOST block, a PC can include this for the
+ * format.
+ *
+ * http://www.hackair.eu/
+*/
+#ifndef HISTORYSERVICE_H
+#define HISTORYSERVICE_H
+
+#define HISTORYSERVICE_RESUME       (0xFFFFFFFFu)
+#define HISTORYSERVICE_AGE_END      (0xFFFFFFFFu)   // Age of the closing notification
+#define HISTORYSERVICE_HEADER_LEN   (8u)
+#define HISTORYSERVICE_RECORD_LEN   (4u)
+#define HISTORYSERVICE_SUMMARY_LEN  (12u)           // Fits the default MTU
+#define HISTORYSERVICE_ATT_HDR      (3u)            // Opcode and handle of a notification
+#define HISTORYSERVICE_L2CAP_HDR    (4u)
+#define HISTORYSERVICE_MTU          (247u)          // As set in the BLE component, see above
+
+#ifdef HACKAIR_HOST
+#include <stdint.h>
+typedef uint8_t uint8;
+typedef uint16_t uint16;
+typedef uint32_t uint32;
+typedef int16_t int16;
+#else
+#include <project.h>
+#include "BLE_custom.h"
+
+#define HISTORYSERVICE_CHAR_HANDLE  (CYBLE_CUSTOM_SERVICE_HISTORY_CHAR_HANDLE)
+#define HISTORYSERVICE_CCCD_HANDLE  (CYBLE_CUSTOM_SERVICE_HISTORY_CLIENT_CHARACTERISTIC_CONFIGURATION_DESC_HANDLE)
+
+/* Connection intervals in 1.25ms, supervision timeouts in 10ms */
+#define HISTORYSERVICE_FAST_INTV_MIN    (6u)    // 7.5ms, as many packets per second as the central allows
+#define HISTORYSERVICE_FAST_INTV_MAX    (12u)
+#define HISTORYSERVICE_FAST_TIMEOUT     (200u)
+#define HISTORYSERVICE_IDLE_INTV_MIN    (80u)   // 100ms, connected but nothing to send
+#define HISTORYSERVICE_IDLE_INTV_MAX    (160u)
+#define HISTORYSERVICE_IDLE_LATENCY     (4u)
+#define HISTORYSERVICE_IDLE_TIMEOUT     (600u)
+
+/* Records kept, what the SRAM of the device leaves next to the stack */
+#define HISTORYSERVICE_RECORDS      ((CYDEV_SRAM_SIZE >= 0x8000u) ? 1536u : 384u)
+
+void HistoryService_Init(void);
+void HistoryService_Add(int16 value, uint32 now);
+#if (CYBLE_GAP_ROLE_PERIPHERAL)
+uint8 HistoryService_Write(CYBLE_GATTS_WRITE_REQ_PARAM_T *req);
+void HistoryService_MtuExchanged(const CYBLE_GATT_XCHG_MTU_PARAM_T *param);
+void HistoryService_Disconnected(void);
+uint8 *HistoryService_Packet(void);
+#endif
+void HistoryService_Pump(void);
+#endif /* HACKAIR_HOST */
+
+#endif /* HISTORYSERVICE_H */
+
+/* [] END OF FILE */
@@ -0,0 +1,151 @@
+/* ========================================
+ * Air Quality Beacon, part of the hackAIR project.
+ * Freely available under CC BY 4.0
+ *
+ * http://www.hackair.eu/
+*/
+#include "LedPattern.h"
+#include "LpTimer.h"
+#include "Scheduler.h"
+#include "Energy.h"
+#include "Settings.h"
+
+typedef struct
+{
+    uint32 bits;    // LED level per step, LSB first
+    uint8  steps;   // Pattern length, 1-32
+} LEDPATTERN_T;
+
+static LEDPATTERN_T patterns[LEDPATTERN_COUNT] =
+{
+    { 0x00000000u,  1u },   // LEDPATTERN_OFF
+    { 0x00000003u,  2u },   // LEDPATTERN_MEASURING: 100ms on
+    { 0x00000003u, 20u },   // LEDPATTERN_WARMUP: 100ms on, 900ms off
+    { 0x00000005u, 80u },   // LEDPATTERN_LOW_BATTERY: two 50ms flashes, 4s period (steps past 32 are off)
+    { 0x00000001u,  4u },   // LEDPATTERN_ERROR: 50ms on, 150ms off
+};
+
+static uint8 taskId = SCHEDULER_NO_TASK;
+static uint8 enabled;
+static uint8 background;    // Repeating pattern
+static uint8 current;       // Pattern playing now, background or a one shot
+static uint8 step;          // Next step of current
+
+#define levelAt(p, s)   (((s) < 32u) ? (uint8)(((p)->bits >> (s)) & 1u) : 0u)
+
+static void setLed(uint8 on){
+    STATUS_Write(on);
+    if(on) Energy_LoadOn(ENERGY_LED, LpTimer_Now());
+    else Energy_LoadOff(ENERGY_LED, LpTimer_Now());
+}
+
+/*******************************************************************
+* NAME :            void ledTask()
+*
+* DESCRIPTION :     Scheduler task, runs on LED edges only. Applies
+*                   the level of the current step, then skips ahead
+*                   over all steps with the same level.
+*/
+static void ledTask(void){
+    const LEDPATTERN_T *p = &patterns[current];
+    uint8 level = levelAt(p, step);
+    uint8 run = 0u;
+    
+    setLed(level);
+    while(levelAt(p, step) == level){
+        run++;
+        if(++step >= p->steps){
+            if(current != background){ // One shot done, fall back to the state pattern
+                current = background;
+                step = 0u;
+                break;
+            }
+            step = 0u;
+            if(run >= p->steps) break; // Constant pattern, nothing more to do
+        }
+    }
+    
+    if((current == LEDPATTERN_OFF) && (level == 0u)){
+        Scheduler_Stop(taskId); // Dark until the next Play/SetBackground
+    }else{
+        Scheduler_Trigger(taskId, LpTimer_Now(), LpTimer_MsToTicks((uint32)run * LEDPATTERN_STEP_MS));
+    }
+}
+
+/* Restart the engine on a new pattern right away */
+static void restart(uint8 id){
+    current = id;
+    step = 0u;
+    if(taskId != SCHEDULER_NO_TASK) Scheduler_Trigger(taskId, LpTimer_Now(), 0u);
+}
+
+/*******************************************************************
+* NAME :            void LedPattern_Start()
+*
+* DESCRIPTION :     Register the LED task with the scheduler. The
+*                   LED stays dark on units with the stealth flag.
+*/
+void LedPattern_Start(void){
+    enabled = ((SETTINGS_FLAGS & SETTINGS_FLAG_STEALTH) == 0u) ? 1u : 0u;
+    background = LEDPATTERN_OFF;
+    current = LEDPATTERN_OFF;
+    step = 0u;
+    setLed(0u);
+    taskId = Scheduler_Add(ledTask, LpTimer_Now(), 0u, 0u);
+    Scheduler_Stop(taskId);
+}
+
+/*******************************************************************
+* NAME :            void LedPattern_Define(uint8 id, uint32 bits, uint8 steps)
+*
+* DESCRIPTION :     Replace a pattern, takes effect on its next start
+* INPUTS :
+*       uint32 bits     LED level per step, LSB first
+*       uint8 steps     Pattern length, steps past 32 are off
+*/
+void LedPattern_Define(uint8 id, uint32 bits, uint8 steps){
+    if((id == LEDPATTERN_OFF) || (id >= LEDPATTERN_COUNT) || (steps == 0u)) return;
+    patterns[id].bits = bits;
+    patterns[id].steps = steps;
+}
+
+/*******************************************************************
+* NAME :            void LedPattern_Play(uint8 id)
+*
+* DESCRIPTION :     Play a pattern once, then return to the
+*                   background pattern
+*/
+void LedPattern_Play(uint8 id){
+    if((enabled == 0u) || (id >= LEDPATTERN_COUNT)) return;
+    restart(id);
+}
+
+/*******************************************************************
+* NAME :            void LedPattern_SetBackground(uint8 id)
+*
+* DESCRIPTION :     Select the repeating pattern for the device state
+*/
+void LedPattern_SetBackground(uint8 id){
+    if((id >= LEDPATTERN_COUNT) || (id == background)) return;
+    background = id;
+    if(enabled != 0u) restart(id);
+}
+
+/*******************************************************************
+* NAME :            void LedPattern_Enable(uint8 enable)
+*
+* DESCRIPTION :     Switch the LED as a whole, units with the
+*                   stealth flag stay dark
+*/
+void LedPattern_Enable(uint8 enable){
+    enabled = ((enable != 0u) && ((SETTINGS_FLAGS & SETTINGS_FLAG_STEALTH) == 0u)) ? 1u : 0u;
+    if(enabled == 0u){
+        current = LEDPATTERN_OFF;
+        Scheduler_Stop(taskId);
+        setLed(0u);
+    }else{
+        restart(background);
+    }
+}
+
+/* [] END OF FILE */
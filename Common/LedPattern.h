@@ -0,0 +1,37 @@
+/* ========================================
+ * Air Quality Beacon, part of the hackAIR project.
+ * Freely available under CC BY 4.0
+ *
+ * STATUS LED pattern engine shared by all sensor firmwares.
+ * A pattern is a bit string played LSB first, one bit per
+ * LEDPATTERN_STEP_MS. The engine runs as a scheduler task that is
+ * only woken on LED edges, so the CPU sleeps while a pattern plays.
+ * One shot patterns play on top of a repeating background pattern
+ * that reflects the device state.
+ *
+ * http://www.hackair.eu/
+*/
+#ifndef LEDPATTERN_H
+#define LEDPATTERN_H
+
+#include <project.h>
+
+#define LEDPATTERN_STEP_MS      (50u)
+
+/* Pattern ids */
+#define LEDPATTERN_OFF          (0u)
+#define LEDPATTERN_MEASURING    (1u)    // Short flash per measurement
+#define LEDPATTERN_WARMUP       (2u)    // Slow blink, sensor not settled yet
+#define LEDPATTERN_LOW_BATTERY  (3u)    // Double flash every 4s
+#define LEDPATTERN_ERROR        (4u)    // Fast blink, sensor not answering
+#define LEDPATTERN_COUNT        (5u)
+
+void LedPattern_Start(void);
+void LedPattern_Define(uint8 id, uint32 bits, uint8 steps);
+void LedPattern_Play(uint8 id);
+void LedPattern_SetBackground(uint8 id);
+void LedPattern_Enable(uint8 enable);
+
+#endif /* LEDPATTERN_H */
+
+/* [] END OF FILE */
@@ -0,0 +1,214 @@
+/* ========================================
+ * Air Quality Beacon, part of the hackAIR project.
+ * Freely available under CC BY 4.0
+ *
+ * http://www.hackair.eu/
+*/
+#include "LiveStream.h"
+#include "HistoryService.h"
+
+#define MASK            (LIVESTREAM_BUFFER - 1u)
+
+static uint8 sampleLen;
+static uint16 minPeriod;
+static volatile uint8 streaming;    // Producers check this first
+static uint16 period;               // Client period in ms, 0 when idle
+
+#if (LIVESTREAM_ENABLED)
+static uint8 queue[LIVESTREAM_BUFFER];
+static volatile uint16 head;        // Written by the producer only
+static volatile uint16 tail;        // Written by LiveStream_Pump() only
+static volatile uint8 dropped;
+static uint8 notify;
+static uint8 batch;
+static uint8 busy;                  // From CYBLE_EVT_STACK_BUSY_STATUS
+#endif
+
+/*******************************************************************
+* NAME :            void LiveStream_Init(uint8 len, uint16 minPeriodMs)
+*
+* DESCRIPTION :     Set the sample format of this firmware
+* INPUTS :
+*       uint8 len           Bytes per sample
+*       uint16 minPeriodMs  Shortest sampling period of the sensor
+*/
+void LiveStream_Init(uint8 len, uint16 minPeriodMs){
+    sampleLen = len;
+    minPeriod = minPeriodMs;
+}
+
+/*******************************************************************
+* NAME :            void LiveStream_Put(const uint8 sample[])
+*
+* DESCRIPTION :     Queue one sample, or count it as dropped when
+*                   the queue is full. Never blocks, safe from one
+*                   interrupt or from the main loop, not both.
+*/
+void LiveStream_Put(const uint8 sample[]){
+#if (LIVESTREAM_ENABLED)
+    uint16 at = head;
+    uint8 i;
+    
+    if(!streaming) return;
+    if((uint16)(at - tail) > (LIVESTREAM_BUFFER - sampleLen)){
+        if(dropped != 0xFFu) dropped++;
+        return;
+    }
+    for(i = 0u; i < sampleLen; i++) queue[(uint16)(at + i) & MASK] = sample[i];
+    head = at + sampleLen; // Publish after the bytes are in
+#else
+    (void)sample;
+#endif
+}
+
+/* Two byte sample, big endian */
+void LiveStream_PutU16(uint16 value){
+    uint8 sample[2];
+    
+    if(!streaming) return;
+    sample[0] = (uint8)(value >> 8);
+    sample[1] = (uint8)(value & 0xFFu);
+    LiveStream_Put(sample);
+}
+
+/*******************************************************************
+* NAME :            uint32 LiveStream_PeriodMs(uint32 periodMs)
+*
+* DESCRIPTION :     Sampling period to use
+* INPUTS :
+*       uint32 periodMs     Period of the firmware's own cadence
+* OUTPUTS :
+*       uint32 The client's period while streaming, else periodMs
+*/
+uint32 LiveStream_PeriodMs(uint32 periodMs){
+    return streaming ? period : periodMs;
+}
+
+#if (CYBLE_GAP_ROLE_PERIPHERAL)
+
+/*******************************************************************
+* NAME :            uint8 LiveStream_Write(CYBLE_GATTS_WRITE_REQ_PARAM_T *req)
+*
+* DESCRIPTION :     Call on CYBLE_EVT_GATTS_WRITE_REQ, then apply
+*                   LiveStream_PeriodMs() to the sampling task
+* OUTPUTS :
+*       uint8 1 if the write was for this service and answered
+*/
+uint8 LiveStream_Write(CYBLE_GATTS_WRITE_REQ_PARAM_T *req){
+#if (LIVESTREAM_ENABLED)
+    CYBLE_GATT_VALUE_T *value = &req->handleValPair.value;
+    
+    if(req->handleValPair.attrHandle == LIVESTREAM_CCCD_HANDLE){
+        notify = ((value->len > 0u) && ((value->val[0] & 0x01u) != 0u)) ? 1u : 0u;
+        (void)CyBle_GattsWriteAttributeValue(&req->handleValPair, 0u, &req->connHandle, CYBLE_GATT_DB_PEER_INITIATED);
+    }else if(req->handleValPair.attrHandle == LIVESTREAM_CHAR_HANDLE){
+        if(value->len != LIVESTREAM_WRITE_LEN){
+            CYBLE_GATTS_ERR_PARAM_T err;
+            
+            err.attrHandle = req->handleValPair.attrHandle;
+            err.opcode = CYBLE_GATT_WRITE_REQ;
+            err.errorCode = CYBLE_GATT_ERR_INVALID_ATTRIBUTE_LEN;
+            (void)CyBle_GattsErrorRsp(req->connHandle, &err);
+            return 1u;
+        }
+        period = (uint16)((value->val[0] << 8) | value->val[1]);
+        batch = value->val[2];
+        if(period == 0u){
+            streaming = 0u;
+        }else{
+            if(period < minPeriod) period = minPeriod;
+            if(period > LIVESTREAM_PERIOD_MAX) period = LIVESTREAM_PERIOD_MAX;
+            if(!streaming){ // Producers are off, the queue is ours
+                head = 0u;
+                tail = 0u;
+                dropped = 0u;
+                streaming = 1u;
+            }
+        }
+    }else{
+        return 0u;
+    }
+    (void)CyBle_GattsWriteRsp(req->connHandle);
+    return 1u;
+#else
+    (void)req;
+    return 0u;
+#endif
+}
+
+/*******************************************************************
+* NAME :            void LiveStream_StackBusy(uint8 state)
+*
+* DESCRIPTION :     Call on CYBLE_EVT_STACK_BUSY_STATUS, the stack
+*                   buffers being full holds the stream back
+*/
+void LiveStream_StackBusy(uint8 state){
+#if (LIVESTREAM_ENABLED)
+    busy = (state == CYBLE_STACK_STATE_BUSY) ? 1u : 0u;
+#else
+    (void)state;
+#endif
+}
+
+/*******************************************************************
+* NAME :            void LiveStream_Disconnected()
+*
+* DESCRIPTION :     Call on CYBLE_EVT_GAP_DEVICE_DISCONNECTED, stops
+*                   the stream. Apply LiveStream_PeriodMs() again.
+*/
+void LiveStream_Disconnected(void){
+    streaming = 0u;
+    period = 0u;
+#if (LIVESTREAM_ENABLED)
+    notify = 0u;
+    busy = 0u;
+#endif
+}
+
+#endif /* CYBLE_GAP_ROLE_PERIPHERAL */
+
+/*******************************************************************
+* NAME :            void LiveStream_Pump()
+*
+* DESCRIPTION :     Send queued samples once a batch is complete,
+*                   until the stack is busy. Call from the main loop
+*                   after CyBle_ProcessEvents().
+*/
+void LiveStream_Pump(void){
+#if (LIVESTREAM_ENABLED)
+    uint16 mtu = CYBLE_GATT_DEFAULT_MTU;
+    uint16 room;
+    uint16 want;
+    
+    if(!streaming || !notify || (CyBle_GetState() != CYBLE_STATE_CONNECTED)) return;
+    (void)CyBle_GattGetMtuSize(&mtu);
+    room = mtu - 3u - LIVESTREAM_HEADER_LEN; // ATT notification header
+    want = (uint16)batch * sampleLen;
+    if((want == 0u) || (want > room)) want = room;
+    
+    while(!busy && ((uint16)(head - tail) >= want)){
+        uint8 *pkt = HistoryService_Packet(); // Never pumped at the same time
+        uint16 avail = head - tail;
+        uint16 len = (avail > room) ? room : avail;
+        uint16 i;
+        CYBLE_GATTS_HANDLE_VALUE_NTF_T ntf;
+        uint8 intr;
+        
+        pkt[0] = sampleLen;
+        for(i = 0u; i < len; i++) pkt[LIVESTREAM_HEADER_LEN + i] = queue[(uint16)(tail + i) & MASK];
+        intr = CyEnterCriticalSection(); // The producer may be an interrupt
+        pkt[1] = dropped;
+        CyExitCriticalSection(intr);
+        ntf.attrHandle = LIVESTREAM_CHAR_HANDLE;
+        ntf.value.val = pkt;
+        ntf.value.len = LIVESTREAM_HEADER_LEN + len;
+        if(CyBle_GattsNotification(cyBle_connHandle, &ntf) != CYBLE_ERROR_OK) break; // Retry on the next pass
+        intr = CyEnterCriticalSection();
+        dropped -= pkt[1]; // Keep what was dropped meanwhile
+        CyExitCriticalSection(intr);
+        tail += len;
+    }
+#endif
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,70 @@
+/* ========================================
+ * Air Quality Beacon, part of the hackAIR project.
+ * Freely available under CC BY 4.0
+ *
+ * Raw sample streaming over GATT for calibration sessions, shared
+ * by all sensor firmwares. Uses the second characteristic of the
+ * custom service in the BLE component, "Live Stream": Write and
+ * Notify with a Client Characteristic Configuration descriptor,
+ * next to the peripheral role of HistoryService.h. Without it
+ * LiveStream_Put() returns straight away.
+ *
+ * Each firmware decides what a sample is, one fixed length per
+ * unit: an ADC conversion per LED pulse, a PPD42 low pulse width
+ * in LF ticks or a whole sensor UART packet. Samples are queued by
+ * the producer, an interrupt included, and dropped when the queue
+ * is full; nothing waits for the radio. The main loop sends them
+ * while the stack reports free buffers.
+ *
+ * The client enables notifications and writes 3 bytes:
+ *
+ *   [0-1]   Sampling period in ms, big endian, clamped to what the
+ *           sensor can do. 0 stops the stream.
+ *   [2]     Samples per notification, 0 fills the ATT MTU
+ *
+ * The sampling period of the firmware follows until the client
+ * stops the stream or disconnects. Each notification:
+ *
+ *   [0]     Sample length in bytes
+ *   [1]     Samples dropped since the previous notification,
+ *           saturated at 255
+ *   [2-]    Sample bytes, oldest first. A sample longer than a
+ *           notification continues in the next one.
+ *
+ * http://www.hackair.eu/
+*/
+#ifndef LIVESTREAM_H
+#define LIVESTREAM_H
+
+#include <project.h>
+#include "BLE_custom.h"
+
+#define LIVESTREAM_HEADER_LEN       (2u)
+#define LIVESTREAM_WRITE_LEN        (3u)
+#define LIVESTREAM_PERIOD_MAX       (60000u)
+
+/* Queue in bytes, a power of 2 */
+#define LIVESTREAM_BUFFER           ((CYDEV_SRAM_SIZE >= 0x8000u) ? 512u : 256u)
+
+#if defined(CYBLE_CUSTOM_SERVICE_LIVE_STREAM_CHAR_HANDLE) && (CYBLE_GAP_ROLE_PERIPHERAL)
+#define LIVESTREAM_ENABLED          (1u)
+#define LIVESTREAM_CHAR_HANDLE      (CYBLE_CUSTOM_SERVICE_LIVE_STREAM_CHAR_HANDLE)
+#define LIVESTREAM_CCCD_HANDLE      (CYBLE_CUSTOM_SERVICE_LIVE_STREAM_CLIENT_CHARACTERISTIC_CONFIGURATION_DESC_HANDLE)
+#else
+#define LIVESTREAM_ENABLED          (0u)
+#endif
+
+void LiveStream_Init(uint8 len, uint16 minPeriodMs);
+void LiveStream_Put(const uint8 sample[]);
+void LiveStream_PutU16(uint16 value);
+uint32 LiveStream_PeriodMs(uint32 periodMs);
+#if (CYBLE_GAP_ROLE_PERIPHERAL)
+uint8 LiveStream_Write(CYBLE_GATTS_WRITE_REQ_PARAM_T *req);
+void LiveStream_StackBusy(uint8 state);
+void LiveStream_Disconnected(void);
+#endif
+void LiveStream_Pump(void);
+
+#endif /* LIVESTREAM_H */
+
+/* [] END OF FILE */
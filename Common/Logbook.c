@@ -0,0 +1,91 @@
+/* ========================================
+ * Air Quality Beacon, part of the hackAIR project.
+ * Freely available under CC BY 4.0
+ *
+ * http://www.hackair.eu/
+*/
+#include "Logbook.h"
+#include "LpTimer.h"
+
+static LOGBOOK_RECORD_T *ring;
+static uint16 size;
+static uint32 end;          // Sequence number of the next record
+static uint32 newestAt;     // LF time the newest gap counts up to
+
+/*******************************************************************
+* NAME :            void Logbook_Init(LOGBOOK_RECORD_T records[], uint16 capacity)
+*
+* DESCRIPTION :     Start an empty log. Without a call, or with no
+*                   capacity, Logbook_Add() does nothing.
+*/
+void Logbook_Init(LOGBOOK_RECORD_T records[], uint16 capacity){
+    ring = records;
+    size = capacity;
+    end = 0u;
+}
+
+/*******************************************************************
+* NAME :            void Logbook_Add(int16 value, uint32 now)
+*
+* DESCRIPTION :     Log a reading
+* INPUTS :
+*       int16 value         Reading in sensor units
+*       uint32 now          LpTimer_Now() of the reading
+*/
+void Logbook_Add(int16 value, uint32 now){
+    uint32 secs = 0u;
+    LOGBOOK_RECORD_T *rec;
+    
+    if(size == 0u) return;
+    if(end != 0u){
+        secs = (now - newestAt) / LpTimer_TicksPerSec();
+        newestAt += secs * LpTimer_TicksPerSec(); // Keep the remainder for the next gap
+    }else{
+        newestAt = now;
+    }
+    rec = &ring[end % size];
+    rec->value = value;
+    rec->gap = (secs > 0xFFFFu) ? 0xFFFFu : (uint16)secs;
+    end++;
+}
+
+/* Oldest sequence number still in the buffer */
+uint32 Logbook_First(void){
+    return (end > size) ? (end - size) : 0u;
+}
+
+uint32 Logbook_End(void){
+    return end;
+}
+
+/*******************************************************************
+* NAME :            const LOGBOOK_RECORD_T *Logbook_Get(uint32 seq)
+*
+* DESCRIPTION :     Record by sequence number
+* OUTPUTS :
+*       LOGBOOK_RECORD_T* 0 if overwritten or not logged yet
+*/
+const LOGBOOK_RECORD_T *Logbook_Get(uint32 seq){
+    if((seq < Logbook_First()) || (seq >= end)) return 0;
+    return &ring[seq % size];
+}
+
+/*******************************************************************
+* NAME :            uint32 Logbook_AgeSecs(uint32 seq, uint32 now)
+*
+* DESCRIPTION :     Seconds since a record was logged, from the
+*                   gaps of the newer ones. Walks the log, call once
+*                   per transfer and follow the gaps from there.
+*/
+uint32 Logbook_AgeSecs(uint32 seq, uint32 now){
+    uint32 age;
+    uint32 s;
+    
+    if((size == 0u) || (end == 0u)) return 0u;
+    age = (now - newestAt) / LpTimer_TicksPerSec();
+    if(seq < Logbook_First()) seq = Logbook_First();
+    for(s = end - 1u; s > seq; s--) age += ring[s % size].gap;
+    return age;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,34 @@
+/* ========================================
+ * Air Quality Beacon, part of the hackAIR project.
+ * Freely available under CC BY 4.0
+ *
+ * Reading log for bulk download over GATT, shared by all sensor
+ * firmwares. Every reading gets a sequence number counting up from
+ * power up, the oldest records are overwritten when the buffer is
+ * full. A record holds the reading and the seconds since the
+ * previous record, so times are rebuilt from the age of any one
+ * record. The buffer is owned by the caller.
+ *
+ * http://www.hackair.eu/
+*/
+#ifndef LOGBOOK_H
+#define LOGBOOK_H
+
+#include <cytypes.h>
+
+typedef struct
+{
+    int16 value;        // Reading in sensor units
+    uint16 gap;         // Seconds since the previous record, saturated
+} LOGBOOK_RECORD_T;
+
+void Logbook_Init(LOGBOOK_RECORD_T records[], uint16 capacity);
+void Logbook_Add(int16 value, uint32 now);
+uint32 Logbook_First(void);
+uint32 Logbook_End(void);
+const LOGBOOK_RECORD_T *Logbook_Get(uint32 seq);
+uint32 Logbook_AgeSecs(uint32 seq, uint32 now);
+
+#endif /* LOGBOOK_H */
+
+/* [] END OF FILE */
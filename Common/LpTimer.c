@@ -0,0 +1,132 @@
+/* ========================================
+ * Air Quality Beacon, part of the hackAIR project.
+ * Freely available under CC BY 4.0
+ *
+ * http://www.hackair.eu/
+*/
+#include "LpTimer.h"
+
+static uint32 ticksPerSec = LPTIMER_TICKS_PER_SEC;
+static uint8 onIlo;
+
+/*******************************************************************
+* NAME :            void LpTimer_Start()
+*
+* DESCRIPTION :     Start the free running LF counter and the alarm
+*                   counter. Safe to call more than once.
+*                   If the WCO doesn't oscillate (no crystal fitted)
+*                   LFCLK is switched to the ILO and calibrated.
+*/
+void LpTimer_Start(void){
+    if(CySysWdtGetEnabledStatus(LPTIMER_COUNTER) == 0u){
+        if((CY_SYS_CLK_WCO_STATUS_REG & CY_SYS_CLK_WCO_STATUS_OUT_BLNK_A) == 0u){
+            // No crystal, LFCLK has no edges to sync on so CySysClkSetLfclkSource()
+            // and CySysWdtEnable() would hang. Switch the mux directly.
+            CySysClkIloStart();
+            CY_SYS_WDT_CONFIG_REG &= ~CY_SYS_CLK_LFCLK_SEL_MASK;
+            CySysClkWcoStop();
+            onIlo = 1u;
+        }
+        CySysWdtSetMode(LPTIMER_COUNTER, CY_SYS_WDT_MODE_NONE); // Count only, no interrupt/reset
+        CySysWdtSetMode(LPTIMER_ALARM_COUNTER, CY_SYS_WDT_MODE_INT);
+        CySysWdtSetClearOnMatch(LPTIMER_ALARM_COUNTER, 0u); // Free running, match only interrupts
+        CySysWdtEnable(LPTIMER_COUNTER_MASK | LPTIMER_ALARM_COUNTER_MASK);
+        CyIntEnable(LPTIMER_WDT_IRQ); // CySysWdtIsr clears the match, the interrupt only wakes us
+        LpTimer_Calibrate();
+    }
+}
+
+/*******************************************************************
+* NAME :            uint32 LpTimer_Now()
+*
+* DESCRIPTION :     Current LF time. Wraps every ~36 hours, compare
+*                   timestamps by unsigned subtraction only.
+* OUTPUTS :
+*       uint32 LFCLK ticks
+*/
+uint32 LpTimer_Now(void){
+    return CySysWdtGetCount(LPTIMER_COUNTER);
+}
+
+/*******************************************************************
+* NAME :            void LpTimer_SetAlarm(uint32 due)
+*
+* DESCRIPTION :     Arm the wakeup interrupt for an absolute LF time.
+*                   Alarms further out than LPTIMER_MAX_ALARM fire
+*                   early, the caller just goes back to sleep.
+*/
+void LpTimer_SetAlarm(uint32 due){
+    uint32 delta = due - LpTimer_Now();
+    
+    if((int32)delta < (int32)LPTIMER_MIN_ALARM) delta = LPTIMER_MIN_ALARM;
+    if(delta > LPTIMER_MAX_ALARM) delta = LPTIMER_MAX_ALARM;
+    CySysWdtSetMatch(LPTIMER_ALARM_COUNTER,
+        (CySysWdtGetCount(LPTIMER_ALARM_COUNTER) + delta) & CY_SYS_WDT_LOWER_16BITS_MASK);
+}
+
+/*******************************************************************
+* NAME :            uint32 LpTimer_TicksPerSec()
+*
+* DESCRIPTION :     LFCLK rate used by the tick conversions. Fixed
+*                   with the WCO, last calibration with the ILO.
+*/
+uint32 LpTimer_TicksPerSec(void){
+    return ticksPerSec;
+}
+
+/* LF time and SysTick count at the next LF edge. Interrupts stay
+   enabled, each poll masks them only for the two register reads.
+   Returns 0 if an interrupt ran between two polls and the edge
+   can't be placed. */
+static uint8 nextEdge(uint32 *tick, uint32 *count){
+    uint32 t0 = LpTimer_Now();
+    uint32 prev = CY_SYS_SYST_CVR_REG;
+    uint8 intr;
+    
+    for(;;){
+        intr = CyEnterCriticalSection();
+        *tick = LpTimer_Now();
+        *count = CY_SYS_SYST_CVR_REG;
+        CyExitCriticalSection(intr);
+        if(*tick != t0) break;
+        prev = *count;
+    }
+    return (((prev - *count) & CY_SYS_SYST_RVR_CNT_MASK) <= LPTIMER_CAL_POLL_MAX) ? 1u : 0u; // SysTick counts down
+}
+
+/*******************************************************************
+* NAME :            void LpTimer_Calibrate()
+*
+* DESCRIPTION :     Time LPTIMER_CAL_TICKS ILO ticks with SysTick on
+*                   the IMO derived SYSCLK and update the tick rate.
+*                   cydelayFreqHz tracks the SYSCLK divider. Busy
+*                   for ~2ms with interrupts enabled, so BLE events
+*                   are served on time. A BLE interrupt right at one
+*                   of the two edges spoils the timing, the rate is
+*                   then kept until the next call. Does nothing with
+*                   the WCO.
+*/
+void LpTimer_Calibrate(void){
+    uint32 t0;
+    uint32 t1;
+    uint32 start;
+    uint32 end;
+    uint32 cycles;
+    uint8 clean;
+    
+    if(onIlo == 0u) return;
+    CY_SYS_SYST_RVR_REG = CY_SYS_SYST_RVR_CNT_MASK;
+    CY_SYS_SYST_CVR_REG = 0u;
+    CY_SYS_SYST_CSR_REG = (CY_SYS_SYST_CSR_CLK_SRC_SYSCLK << CY_SYS_SYST_CSR_CLK_SOURCE_SHIFT) |
+                          CY_SYS_SYST_CSR_ENABLE; // No interrupt, only the counter is used
+    clean = nextEdge(&t0, &start);
+    while((LpTimer_Now() - t0) < (LPTIMER_CAL_TICKS - 1u));
+    clean &= nextEdge(&t1, &end);
+    if((t1 - t0) != LPTIMER_CAL_TICKS) clean = 0u; // Held up past the last edge
+    cycles = (start - end) & CY_SYS_SYST_RVR_CNT_MASK; // 64 ticks at 48MHz, well inside 24 bits
+    CY_SYS_SYST_CSR_REG = 0u;
+    
+    if(clean && (cycles != 0u)) ticksPerSec = (LPTIMER_CAL_TICKS * cydelayFreqHz) / cycles; // 64 * 48MHz fits 32 bits
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,45 @@
+/* ========================================
+ * Air Quality Beacon, part of the hackAIR project.
+ * Freely available under CC BY 4.0
+ *
+ * Low frequency timebase shared by all sensor firmwares.
+ * WDT counter 2 is left free running on LFCLK (WCO, 32.768kHz)
+ * and keeps counting in deep sleep. WDT counter 0 provides the
+ * wakeup alarm for the scheduler.
+ * Boards without a watch crystal fall back to the ILO, whose rate
+ * is measured against the IMO so tick conversions stay accurate.
+ *
+ * http://www.hackair.eu/
+*/
+#ifndef LPTIMER_H
+#define LPTIMER_H
+
+#include <project.h>
+
+#define LPTIMER_COUNTER             (CY_SYS_WDT_COUNTER2)
+#define LPTIMER_COUNTER_MASK        (CY_SYS_WDT_COUNTER2_MASK)
+#define LPTIMER_ALARM_COUNTER       (CY_SYS_WDT_COUNTER0)
+#define LPTIMER_ALARM_COUNTER_MASK  (CY_SYS_WDT_COUNTER0_MASK)
+#define LPTIMER_WDT_IRQ             (8u)        // cyfitter_cfg.c routes CySysWdtIsr here
+#define LPTIMER_TICKS_PER_SEC       (32768u)    // Nominal rate with the WCO fitted
+#define LPTIMER_CAL_TICKS           (64u)       // ILO ticks timed against SYSCLK, ~2ms
+#define LPTIMER_CAL_POLL_MAX        (200u)      // SYSCLK cycles between two polls that still place an LF edge
+#define LPTIMER_MIN_ALARM           (8u)        // Match register needs ~3 LF cycles to sync
+#define LPTIMER_MAX_ALARM           (0xFF00u)   // Counter 0 is 16 bit
+
+/* Split in whole seconds and remainder so long intervals don't overflow */
+#define LpTimer_MsToTicks(ms)   ((((uint32)(ms) / 1000u) * LpTimer_TicksPerSec()) + \
+                                ((((uint32)(ms) % 1000u) * LpTimer_TicksPerSec()) / 1000u))
+#define LpTimer_TicksToMs(t)    ((((uint32)(t) / LpTimer_TicksPerSec()) * 1000u) + \
+                                ((((uint32)(t) % LpTimer_TicksPerSec()) * 1000u) / LpTimer_TicksPerSec()))
+
+void LpTimer_Start(void);
+uint32 LpTimer_Now(void);
+void LpTimer_SetAlarm(uint32 due);
+
+uint32 LpTimer_TicksPerSec(void);
+void LpTimer_Calibrate(void);
+
+#endif /* LPTIMER_H */
+
+/* [] END OF FILE */
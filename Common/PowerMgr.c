@@ -0,0 +1,100 @@
+/* ========================================
+ * Air Quality Beacon, part of the hackAIR project.
+ * Freely available under CC BY 4.0
+ *
+ * http://www.hackair.eu/
+*/
+#include "PowerMgr.h"
+#include "LpTimer.h"
+#include "Energy.h"
+#include "ClockMgr.h"
+
+static uint8 lastMode;
+
+/*******************************************************************
+* NAME :            uint8 enterLowPower(uint8 deepSleep)
+*
+* DESCRIPTION :     Put BLESS and then the CPU in the lowest mode
+*                   allowed. The BLESS state is sampled with
+*                   interrupts disabled so a BLE interrupt can't
+*                   slip in between the check and the WFI; a pending
+*                   interrupt still wakes the CPU.
+* OUTPUTS :
+*       uint8 POWERMGR_ACTIVE, POWERMGR_SLEEP or POWERMGR_DEEPSLEEP
+*/
+static uint8 enterLowPower(uint8 deepSleep){
+    uint8 mode = POWERMGR_ACTIVE;
+    
+    if(CyBle_GetState() == CYBLE_STATE_INITIALIZING){ // Stack not ready for LPM requests yet
+        Energy_SetCpu(ENERGY_CPU_SLEEP, LpTimer_Now());
+        CySysPmSleep();
+        Energy_SetCpu(ENERGY_CPU_ACTIVE, LpTimer_Now());
+        return POWERMGR_SLEEP;
+    }
+    
+    if((CyBle_GetState() == CYBLE_STATE_STOPPED) && (deepSleep != 0u)){ // Stack shut down, no radio to wait for
+        Energy_SetCpu(ENERGY_CPU_DEEPSLEEP, LpTimer_Now());
+        CySysPmDeepSleep();
+        Energy_SetCpu(ENERGY_CPU_ACTIVE, LpTimer_Now());
+        return POWERMGR_DEEPSLEEP;
+    }
+    
+    CyBle_EnterLPM(CYBLE_BLESS_DEEPSLEEP); // BLESS sleeps between radio events on its own
+    
+    uint8 intr = CyEnterCriticalSection();
+    CYBLE_BLESS_STATE_T blessState = CyBle_GetBleSsState();
+    
+    if((blessState == CYBLE_BLESS_STATE_ECO_ON) || (blessState == CYBLE_BLESS_STATE_DEEPSLEEP)){
+        if(deepSleep != 0u){
+            ClockMgr_Set(CLOCKMGR_FAST); // Most wakeups are BLE interrupts
+            Energy_SetCpu(ENERGY_CPU_DEEPSLEEP, LpTimer_Now());
+            CySysPmDeepSleep(); // ECO is off or still starting, nothing needs HFCLK
+            mode = POWERMGR_DEEPSLEEP;
+        }else{
+            ClockMgr_Set(CLOCKMGR_SLOW); // Only UART bytes to catch until the next radio event
+            Energy_SetCpu(ENERGY_CPU_SLEEP, LpTimer_Now());
+            CySysPmSleep(); // Caller needs HFCLK peripherals (UART)
+            mode = POWERMGR_SLEEP;
+        }
+    }else if(blessState != CYBLE_BLESS_STATE_EVENT_CLOSE){
+        ClockMgr_Set(CLOCKMGR_FAST); // BLE interrupt is due
+        Energy_SetCpu(ENERGY_CPU_SLEEP, LpTimer_Now());
+        CySysPmSleep(); // Radio event in progress, wait for its interrupt
+        mode = POWERMGR_SLEEP;
+    }
+    // EVENT_CLOSE: BLESS is about to go down, loop again and retry
+    Energy_SetCpu(ENERGY_CPU_ACTIVE, LpTimer_Now());
+    
+    CyExitCriticalSection(intr);
+    return mode;
+}
+
+/*******************************************************************
+* NAME :            uint32 PowerMgr_Idle(uint32 due, uint8 deepSleep)
+*
+* DESCRIPTION :     Sleep until the LF alarm at due, a BLE event or
+*                   any other interrupt.
+* INPUTS :
+*       uint32 due          Absolute LF time to wake up at
+*       uint8 deepSleep     0 keeps HFCLK peripherals (UART) running
+* OUTPUTS :
+*       uint32 LF ticks spent asleep
+*/
+uint32 PowerMgr_Idle(uint32 due, uint8 deepSleep){
+    uint32 start = LpTimer_Now();
+    
+    if((int32)(due - start) <= 0){
+        lastMode = POWERMGR_ACTIVE;
+        return 0u;
+    }
+    LpTimer_SetAlarm(due);
+    
+    lastMode = enterLowPower(deepSleep);
+    return (lastMode == POWERMGR_ACTIVE) ? 0u : (LpTimer_Now() - start);
+}
+
+uint8 PowerMgr_LastMode(void){
+    return lastMode;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,27 @@
+/* ========================================
+ * Air Quality Beacon, part of the hackAIR project.
+ * Freely available under CC BY 4.0
+ *
+ * Low power mode selection shared by all sensor firmwares.
+ * Call PowerMgr_Idle() right after CyBle_ProcessEvents(): BLESS is
+ * asked to deep sleep between radio events and the CPU follows it
+ * into deep sleep whenever the BLE sub system state allows it.
+ *
+ * http://www.hackair.eu/
+*/
+#ifndef POWERMGR_H
+#define POWERMGR_H
+
+#include <project.h>
+
+/* Mode the CPU went to in the last PowerMgr_Idle() call */
+#define POWERMGR_ACTIVE         (0u)    // Too close to a radio event, stayed awake
+#define POWERMGR_SLEEP          (1u)
+#define POWERMGR_DEEPSLEEP      (2u)
+
+uint32 PowerMgr_Idle(uint32 due, uint8 deepSleep);
+uint8 PowerMgr_LastMode(void);
+
+#endif /* POWERMGR_H */
+
+/* [] END OF FILE */
@@ -0,0 +1,153 @@
+/* ========================================
+ * Air Quality Beacon, part of the hackAIR project.
+ * Freely available under CC BY 4.0
+ *
+ * http://www.hackair.eu/
+*/
+#include "Scheduler.h"
+
+typedef struct
+{
+    SCHEDULER_TASK_FN_T fn;
+    uint32 due;     // Absolute tick of next run
+    uint32 period;  // 0 = one shot
+    uint8  armed;
+} SCHEDULER_TASK_T;
+
+static SCHEDULER_TASK_T tasks[SCHEDULER_MAX_TASKS];
+static uint8 taskCount;
+static uint32 statsStart;
+static uint32 sleepTicks;
+
+/* Wrap safe "a is at or before b" */
+#define isDue(due, now)     ((int32)((due) - (now)) <= 0)
+
+/*******************************************************************
+* NAME :            uint8 Scheduler_Add(fn, now, delay, period)
+*
+* DESCRIPTION :     Register a task, first run at now + delay
+* OUTPUTS :
+*       uint8 Task id or SCHEDULER_NO_TASK
+*/
+uint8 Scheduler_Add(SCHEDULER_TASK_FN_T fn, uint32 now, uint32 delay, uint32 period){
+    if(taskCount >= SCHEDULER_MAX_TASKS) return SCHEDULER_NO_TASK;
+    
+    SCHEDULER_TASK_T *t = &tasks[taskCount];
+    t->fn = fn;
+    t->due = now + delay;
+    t->period = period;
+    t->armed = 1u;
+    return taskCount++;
+}
+
+/*******************************************************************
+* NAME :            void Scheduler_Trigger(uint8 id, uint32 now, uint32 delay)
+*
+* DESCRIPTION :     (Re)arm a task to run at now + delay
+*/
+void Scheduler_Trigger(uint8 id, uint32 now, uint32 delay){
+    if(id >= taskCount) return;
+    tasks[id].due = now + delay;
+    tasks[id].armed = 1u;
+}
+
+void Scheduler_SetPeriod(uint8 id, uint32 period){
+    if(id < taskCount) tasks[id].period = period;
+}
+
+/*******************************************************************
+* NAME :            void Scheduler_ChangePeriod(uint8 id, uint32 now, uint32 period)
+*
+* DESCRIPTION :     Switch a periodic task to a new period, the next
+*                   run is one new period from now. No effect if the
+*                   period is unchanged.
+*/
+void Scheduler_ChangePeriod(uint8 id, uint32 now, uint32 period){
+    if((id >= taskCount) || (tasks[id].period == period)) return;
+    tasks[id].period = period;
+    Scheduler_Trigger(id, now, period);
+}
+
+void Scheduler_Stop(uint8 id){
+    if(id < taskCount) tasks[id].armed = 0u;
+}
+
+uint8 Scheduler_IsArmed(uint8 id){
+    return (id < taskCount) ? tasks[id].armed : 0u;
+}
+
+/*******************************************************************
+* NAME :            void Scheduler_Dispatch(uint32 now)
+*
+* DESCRIPTION :     Run every task that is due. A periodic task that
+*                   fell behind by more than one period is re-phased
+*                   instead of being run back to back.
+*/
+void Scheduler_Dispatch(uint32 now){
+    uint8 i;
+    
+    for(i = 0u; i < taskCount; i++){
+        SCHEDULER_TASK_T *t = &tasks[i];
+        if((t->armed == 0u) || !isDue(t->due, now)) continue;
+        
+        if(t->period != 0u){
+            t->due += t->period;
+            if(isDue(t->due, now)) t->due = now + t->period;
+        }else{
+            t->armed = 0u;
+        }
+        t->fn(); // May re-arm itself or other tasks
+    }
+}
+
+/*******************************************************************
+* NAME :            uint32 Scheduler_NextDue(uint32 now)
+*
+* DESCRIPTION :     Earliest due time of all armed tasks
+* OUTPUTS :
+*       uint32 Absolute tick, now if something is already due,
+*              now + SCHEDULER_MAX_SLEEP if nothing is armed
+*/
+uint32 Scheduler_NextDue(uint32 now){
+    uint32 wait = SCHEDULER_MAX_SLEEP;
+    uint8 i;
+    
+    for(i = 0u; i < taskCount; i++){
+        if(tasks[i].armed == 0u) continue;
+        if(isDue(tasks[i].due, now)) return now;
+        if((tasks[i].due - now) < wait) wait = tasks[i].due - now;
+    }
+    return now + wait;
+}
+
+void Scheduler_AddSleep(uint32 ticks){
+    sleepTicks += ticks;
+}
+
+/*******************************************************************
+* NAME :            uint16 Scheduler_DutyPermille(uint32 now)
+*
+* DESCRIPTION :     Share of time the CPU was awake since the last
+*                   Scheduler_ResetStats()
+* OUTPUTS :
+*       uint16 Active time in 0.1% steps
+*/
+uint16 Scheduler_DutyPermille(uint32 now){
+    uint32 total = now - statsStart;
+    uint32 active;
+    
+    if(total == 0u) return 0u;
+    active = (sleepTicks < total) ? (total - sleepTicks) : 0u;
+    if(total > (0xFFFFFFFFu / 1000u)){ // Keep the product in 32 bits
+        active >>= 10;
+        total >>= 10;
+    }
+    return (uint16)((active * 1000u) / total);
+}
+
+void Scheduler_ResetStats(uint32 now){
+    statsStart = now;
+    sleepTicks = 0u;
+}
+
+/* [] END OF FILE */
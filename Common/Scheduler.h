@@ -0,0 +1,53 @@
+/* ========================================
+ * Air Quality Beacon, part of the hackAIR project.
+ * Freely available under CC BY 4.0
+ *
+ * Tickless cooperative scheduler shared by all sensor firmwares.
+ * Time is passed in by the caller (LF timer ticks on target, a
+ * virtual clock on a host), so this file has no hardware access,
+ * build with HACKAIR_HOST to use it on a PC.
+ * Tasks run to completion from Scheduler_Dispatch(); between
+ * events the caller sleeps until Scheduler_NextDue().
+ *
+ * http://www.hackair.eu/
+*/
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#ifdef HACKAIR_HOST
+#include <stdint.h>
+typedef uint8_t uint8;
+typedef uint16_t uint16;
+typedef uint32_t uint32;
+typedef int32_t int32;
+#else
+#include <cytypes.h>
+#endif
+
+#define SCHEDULER_MAX_TASKS     (8u)
+#define SCHEDULER_NO_TASK       (0xFFu)
+#define SCHEDULER_MAX_SLEEP     (0x10000000u) // Sleep bound when nothing is scheduled
+
+typedef void (*SCHEDULER_TASK_FN_T)(void);
+
+/* Returns a task id, SCHEDULER_NO_TASK if the table is full.
+ * period 0 makes a one shot task which stays registered and can be
+ * re-armed with Scheduler_Trigger(). */
+uint8 Scheduler_Add(SCHEDULER_TASK_FN_T fn, uint32 now, uint32 delay, uint32 period);
+void Scheduler_Trigger(uint8 id, uint32 now, uint32 delay);
+void Scheduler_SetPeriod(uint8 id, uint32 period);
+void Scheduler_ChangePeriod(uint8 id, uint32 now, uint32 period);
+void Scheduler_Stop(uint8 id);
+uint8 Scheduler_IsArmed(uint8 id);
+
+void Scheduler_Dispatch(uint32 now);
+uint32 Scheduler_NextDue(uint32 now);
+
+/* Duty cycle accounting: the caller reports time spent in CPU sleep */
+void Scheduler_AddSleep(uint32 ticks);
+uint16 Scheduler_DutyPermille(uint32 now);
+void Scheduler_ResetStats(uint32 now);
+
+#endif /* SCHEDULER_H */
+
+/* [] END OF FILE */
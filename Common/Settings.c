@@ -0,0 +1,174 @@
+/* ========================================
+ * Air Quality Beacon, part of the hackAIR project.
+ * Freely available under CC BY 4.0
+ *
+ * http://www.hackair.eu/
+*/
+#include "Settings.h"
+#include "AdvConfig.h"
+#include "TxPower.h"
+#include "ClockMgr.h"
+
+#define SEQ_OFFSET      (64u)
+#define CRC_OFFSET      (66u)
+
+static uint16 getLe(const volatile uint8 *p){
+    return (uint16)(p[0] | ((uint16)p[1] << 8));
+}
+
+/* CRC-16/CCITT, 0xFFFF start */
+static uint16 crc16(const volatile uint8 *data, uint8 len){
+    uint16 crc = 0xFFFFu;
+    uint8 bit;
+    
+    while(len-- > 0u){
+        crc ^= (uint16)(*data++) << 8;
+        for(bit = 0u; bit < 8u; bit++) crc = ((crc & 0x8000u) != 0u) ? (uint16)((crc << 1) ^ 0x1021u) : (uint16)(crc << 1);
+    }
+    return crc;
+}
+
+static uint8 sealed(const volatile uint8 *row){
+    return (crc16(row, CRC_OFFSET) == getLe(&row[CRC_OFFSET])) ? 1u : 0u;
+}
+
+/* Break the seal of the journal once row 0 holds its content, a
+   programmer writing row 0 afterwards is not undone at the next boot */
+static void retire(uint8 row[]){
+    row[CRC_OFFSET] ^= 0xFFu;
+    (void)CySysSFlashWriteUserRow(1u, row);
+    row[CRC_OFFSET] ^= 0xFFu;
+}
+
+/* Parameter at offset, 0 if the block is not valid */
+static uint16 param(uint8 offset){
+    return (SETTINGS_ROW[2] == SETTINGS_VERSION) ? getLe(&SETTINGS_ROW[offset]) : 0u;
+}
+
+/*******************************************************************
+* NAME :            void Settings_Recover()
+*
+* DESCRIPTION :     Finish a commit cut short by a reset or a power
+*                   loss. Call first thing at boot, before anything
+*                   reads row 0.
+*/
+void Settings_Recover(void){
+    uint8 row[SETTINGS_ROW_LEN];
+    uint16 i;
+    uint8 differs = 0u;
+    
+    if(!sealed(SETTINGS_JOURNAL)) return;
+    for(i = 0u; i < SETTINGS_ROW_LEN; i++){
+        row[i] = SETTINGS_JOURNAL[i];
+        if(row[i] != SETTINGS_ROW[i]) differs = 1u;
+    }
+    if(differs && (CySysSFlashWriteUserRow(0u, row) != CY_SYS_SFLASH_SUCCESS)) return; // Next boot retries
+    retire(row);
+}
+
+/*******************************************************************
+* NAME :            uint8 Settings_Check(const uint8 row[])
+*
+* DESCRIPTION :     Validate a row 0 image before Settings_Commit()
+* OUTPUTS :
+*       uint8 SETTINGS_OK or the SETTINGS_ERR_* of the first problem
+*/
+uint8 Settings_Check(const uint8 row[]){
+    uint16 slowS = getLe(&row[4]);
+    uint16 burstMs = getLe(&row[6]);
+    uint32 slowMs = (slowS != 0u) ? (slowS * 1000ul) : SETTINGS_SLOW_DEFAULT_MS;
+    uint16 advMin = getLe(&row[12]);
+    uint16 advMax = getLe(&row[14]);
+    
+    if(((row[1] & 0x0Fu) > TXPOWER_LEVEL_MAX) || ((row[1] >> 4) > TXPOWER_LEVEL_MAX)) return SETTINGS_ERR_TXPOWER;
+    if((row[16] == 'h') && (row[17] == 'A') && (row[19] > ADVCONFIG_NAME_MAX)) return SETTINGS_ERR_NAME;
+    if(row[2] != SETTINGS_VERSION) return ((row[2] == 0x00u) || (row[2] == 0xFFu)) ? SETTINGS_OK : SETTINGS_ERR_VERSION;
+    
+    if(row[3] > SETTINGS_AVERAGE_MAX) return SETTINGS_ERR_RANGE;
+    if(slowS > SETTINGS_SLOW_MAX_S) return SETTINGS_ERR_RANGE;
+    if((burstMs != 0u) && (burstMs < SETTINGS_BURST_MIN_MS)) return SETTINGS_ERR_RANGE;
+    if(((burstMs != 0u) ? burstMs : SETTINGS_BURST_DEFAULT_MS) >= slowMs) return SETTINGS_ERR_RANGE; // A burst has to sample faster
+    if((advMin != 0u) && ((advMin < SETTINGS_ADV_MIN) || (advMin > SETTINGS_ADV_MAX))) return SETTINGS_ERR_RANGE;
+    if((advMax != 0u) && ((advMax < SETTINGS_ADV_MIN) || (advMax > SETTINGS_ADV_MAX))) return SETTINGS_ERR_RANGE;
+    if((advMin != 0u) && (advMax != 0u) && (advMin > advMax)) return SETTINGS_ERR_RANGE;
+    return SETTINGS_OK;
+}
+
+/*******************************************************************
+* NAME :            uint8 Settings_Commit(uint8 row[])
+*
+* DESCRIPTION :     Replace row 0, through the journal in row 1.
+*                   Stalls the CPU for three SFLASH row writes, call
+*                   with the BLE stack stopped. The image gets the
+*                   next commit count and its CRC.
+* INPUTS :
+*       uint8 row[SETTINGS_ROW_LEN]     Checked row 0 image
+* OUTPUTS :
+*       uint8 SETTINGS_OK or SETTINGS_ERR_FLASH
+*/
+uint8 Settings_Commit(uint8 row[]){
+    uint16 seq = Settings_Sequence() + 1u;
+    uint16 crc;
+    uint8 prev;
+    uint8 result = SETTINGS_OK;
+    
+    row[SEQ_OFFSET] = (uint8)(seq & 0xFFu);
+    row[SEQ_OFFSET + 1u] = (uint8)(seq >> 8);
+    crc = crc16(row, CRC_OFFSET);
+    row[CRC_OFFSET] = (uint8)(crc & 0xFFu);
+    row[CRC_OFFSET + 1u] = (uint8)(crc >> 8);
+    
+    prev = ClockMgr_Set(CLOCKMGR_FAST); // SPC needs the full HFCLK
+    if(CySysSFlashWriteUserRow(1u, row) != CY_SYS_SFLASH_SUCCESS) result = SETTINGS_ERR_FLASH;
+    else if(CySysSFlashWriteUserRow(0u, row) != CY_SYS_SFLASH_SUCCESS) result = SETTINGS_ERR_FLASH; // Settings_Recover() retries
+    else retire(row);
+    (void)ClockMgr_Set(prev);
+    return result;
+}
+
+/* Commits so far, 0 for a row 0 from the programmer */
+uint16 Settings_Sequence(void){
+    return sealed(SETTINGS_ROW) ? getLe(&SETTINGS_ROW[SEQ_OFFSET]) : 0u;
+}
+
+/*******************************************************************
+* NAME :            uint8 Settings_Average(uint8 count)
+*
+* DESCRIPTION :     Readings to average per measurement
+* INPUTS :
+*       uint8 count     Default of the firmware
+*/
+uint8 Settings_Average(uint8 count){
+    uint16 n = param(3u) & 0xFFu;
+    
+    return (n != 0u) ? (uint8)n : count;
+}
+
+/*******************************************************************
+* NAME :            void Settings_Cadence(const CADENCE_CONFIG_T *defaults, CADENCE_CONFIG_T *config)
+*
+* DESCRIPTION :     Measurement cadence with the parameters of the
+*                   unit applied, config is what Cadence_Init() got
+*/
+void Settings_Cadence(const CADENCE_CONFIG_T *defaults, CADENCE_CONFIG_T *config){
+    *config = *defaults;
+    if(param(4u) != 0u) config->slowPeriodMs = param(4u) * 1000ul;
+    if(param(6u) != 0u) config->burstPeriodMs = param(6u);
+    if(param(8u) != 0u) config->levelThreshold = param(8u);
+    if(param(10u) != 0u) config->rateThreshold = param(10u);
+}
+
+/*******************************************************************
+* NAME :            void Settings_AdvPolicy(const ADVPOLICY_CONFIG_T *defaults, ADVPOLICY_CONFIG_T *config)
+*
+* DESCRIPTION :     Advertising intervals with the parameters of the
+*                   unit applied, config is what AdvPolicy_Init() got
+*/
+void Settings_AdvPolicy(const ADVPOLICY_CONFIG_T *defaults, ADVPOLICY_CONFIG_T *config){
+    *config = *defaults;
+    if(param(12u) != 0u) config->minInterval = param(12u);
+    if(param(14u) != 0u) config->maxInterval = param(14u);
+    if(config->minInterval > config->maxInterval) config->minInterval = config->maxInterval; // One of them left at the default
+}
+
+/* [] END OF FILE */
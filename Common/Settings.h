@@ -0,0 +1,83 @@
+/* ========================================
+ * Air Quality Beacon, part of the hackAIR project.
+ * Freely available under CC BY 4.0
+ *
+ * Measurement parameters of the unit configuration in SFLASH user
+ * row 0, and the commit of a new row 0 as a whole, shared by all
+ * sensor firmwares. The parameters override the defaults compiled
+ * into each firmware, 0 keeps the default, all little endian:
+ *
+ *   [0]     Flags, SETTINGS_FLAG_*
+ *   [1]     TX power levels, see TxPower.h
+ *   [2]     SETTINGS_VERSION marks a valid block
+ *   [3]     Readings averaged per measurement, LED sensors
+ *   [4-5]   Sampling period in stable air, s
+ *   [6-7]   Sampling period during a burst, ms, below the slow one
+ *   [8-9]   Reading that starts a burst, sensor units
+ *   [10-11] Step between two readings that starts a burst
+ *   [12-13] Advertising interval after a change, 0.625ms units
+ *   [14-15] Advertising interval for stable values
+ *   [64-65] Commit count
+ *   [66-67] CRC-16/CCITT of bytes 0-65
+ *
+ * The other bytes belong to the modules reading them, see the
+ * *_CONFIG_* defines. A commit writes the new row to user row 1
+ * first and to row 0 after, then breaks the CRC of row 1. A row 1
+ * with a good CRC at boot is an interrupted commit and is finished
+ * then. Units provisioned with a programmer have no CRC and are left
+ * alone, reprovisioning one that took a commit is kept as well.
+ *
+ * http://www.hackair.eu/
+*/
+#ifndef SETTINGS_H
+#define SETTINGS_H
+
+#include <project.h>
+#include "Cadence.h"
+#include "AdvPolicy.h"
+
+#define SETTINGS_ROW            ((reg8 *)CY_SFLASH_USERBASE)
+#define SETTINGS_JOURNAL        ((reg8 *)(CY_SFLASH_USERBASE + CY_SFLASH_SIZEOF_USERROW))
+#define SETTINGS_ROW_LEN        (CY_SFLASH_SIZEOF_USERROW)
+#define SETTINGS_USED_LEN       (68u)       // Up to the CRC, the rest of the row is kept as is
+#define SETTINGS_VERSION        (0x01u)
+
+/* Per unit switches in the flags byte, set on selected units without
+ * a dedicated build */
+#define SETTINGS_FLAGS              (*(reg8 *)CY_SFLASH_USERBASE)
+#define SETTINGS_FLAG_HISTOGRAM     (0x01u)     // PPD42 pulse width histogram page
+#define SETTINGS_FLAG_STEALTH       (0x02u)     // LED dark whatever the state
+#define SETTINGS_FLAG_NOSCALE       (0x04u)     // SYSCLK stays at full speed
+#define SETTINGS_FLAG_LONG_INTERVAL (0x08u)     // Dormant between reports
+#define SETTINGS_FLAG_EDDYSTONE     (0x10u)     // Eddystone-UID and -TLM pages
+#define SETTINGS_FLAG_NON_SCANNABLE (0x20u)     // Non connectable, non scannable advertising, broadcaster builds
+
+/* Limits of the parameters */
+#define SETTINGS_AVERAGE_MAX    (16u)       // ~180ms of LED pulses, inside the sensor stage deadline
+#define SETTINGS_SLOW_MAX_S     (3600u)
+#define SETTINGS_BURST_MIN_MS   (100u)
+#define SETTINGS_SLOW_DEFAULT_MS    (10000u)    // Compiled in slow period of every firmware
+#define SETTINGS_BURST_DEFAULT_MS   (2000u)     // Longest compiled in burst period, the PPD42 window
+#define SETTINGS_ADV_MIN        (0x00A0u)   // 100ms, scannable advertising
+#define SETTINGS_ADV_MAX        (0x4000u)   // 10.24s
+
+/* Settings_Check() results */
+#define SETTINGS_OK             (0x00u)
+#define SETTINGS_ERR_VERSION    (0x01u)     // Unknown parameter block version
+#define SETTINGS_ERR_RANGE      (0x02u)     // Parameter out of its limits
+#define SETTINGS_ERR_TXPOWER    (0x03u)     // TX power level out of range
+#define SETTINGS_ERR_NAME       (0x04u)     // Advertised name too long
+#define SETTINGS_ERR_FLASH      (0x05u)     // SFLASH write failed
+
+void Settings_Recover(void);
+uint8 Settings_Check(const uint8 row[]);
+uint8 Settings_Commit(uint8 row[]);
+uint16 Settings_Sequence(void);
+
+uint8 Settings_Average(uint8 count);
+void Settings_Cadence(const CADENCE_CONFIG_T *defaults, CADENCE_CONFIG_T *config);
+void Settings_AdvPolicy(const ADVPOLICY_CONFIG_T *defaults, ADVPOLICY_CONFIG_T *config);
+
+#endif /* SETTINGS_H */
+
+/* [] END OF FILE */
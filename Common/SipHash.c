@@ -0,0 +1,71 @@
+/* ========================================
+ * Air Quality Beacon, part of the hackAIR project.
+ * Freely available under CC BY 4.0
+ *
+ * http://www.hackair.eu/
+*/
+#include "SipHash.h"
+
+#define ROTL(x, b)  (((x) << (b)) | ((x) >> (64u - (b))))
+
+/* Little endian 64 bit word */
+static uint64 load(const uint8 *p){
+    uint64 v = 0u;
+    uint8 i;
+    
+    for(i = 8u; i > 0u; i--) v = (v << 8) | p[i - 1u];
+    return v;
+}
+
+static void sipRound(uint64 v[4]){
+    v[0] += v[1]; v[1] = ROTL(v[1], 13u); v[1] ^= v[0]; v[0] = ROTL(v[0], 32u);
+    v[2] += v[3]; v[3] = ROTL(v[3], 16u); v[3] ^= v[2];
+    v[0] += v[3]; v[3] = ROTL(v[3], 21u); v[3] ^= v[0];
+    v[2] += v[1]; v[1] = ROTL(v[1], 17u); v[1] ^= v[2]; v[2] = ROTL(v[2], 32u);
+}
+
+/*******************************************************************
+* NAME :            uint64 SipHash_24(key, data, len)
+*
+* DESCRIPTION :     SipHash-2-4 of data, as the reference
+*                   implementation
+* INPUTS :
+*       uint8 key[16]   Secret key
+*       uint8 data[]    Message, up to 255 bytes
+*/
+uint64 SipHash_24(const uint8 key[SIPHASH_KEY_LEN], const uint8 data[], uint8 len){
+    uint64 k0 = load(key);
+    uint64 k1 = load(&key[8]);
+    uint64 v[4];
+    uint64 m;
+    uint8 i = 0u;
+    uint8 j;
+    
+    v[0] = k0 ^ 0x736f6d6570736575uLL;
+    v[1] = k1 ^ 0x646f72616e646f6duLL;
+    v[2] = k0 ^ 0x6c7967656e657261uLL;
+    v[3] = k1 ^ 0x7465646279746573uLL;
+    
+    for(; (uint8)(len - i) >= 8u; i += 8u){
+        m = load(&data[i]);
+        v[3] ^= m;
+        sipRound(v);
+        sipRound(v);
+        v[0] ^= m;
+    }
+    m = (uint64)len << 56;
+    for(j = 0u; (uint8)(i + j) < len; j++) m |= (uint64)data[i + j] << (8u * j);
+    v[3] ^= m;
+    sipRound(v);
+    sipRound(v);
+    v[0] ^= m;
+    
+    v[2] ^= 0xFFu;
+    sipRound(v);
+    sipRound(v);
+    sipRound(v);
+    sipRound(v);
+    return v[0] ^ v[1] ^ v[2] ^ v[3];
+}
+
+/* [] END OF FILE */
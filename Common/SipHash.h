@@ -0,0 +1,29 @@
+/* ========================================
+ * Air Quality Beacon, part of the hackAIR project.
+ * Freely available under CC BY 4.0
+ *
+ * SipHash-2-4 keyed hash, shared by all sensor firmwares and by
+ * receivers, for the advertising frame tag. Only adds, rotates and
+ * XORs, about 2k cycles for a frame on the Cortex-M0, no tables.
+ * No hardware access. Build with HACKAIR_HOST to use it on a PC.
+ *
+ * http://www.hackair.eu/
+*/
+#ifndef SIPHASH_H
+#define SIPHASH_H
+
+#ifdef HACKAIR_HOST
+#include <stdint.h>
+typedef uint8_t uint8;
+typedef uint64_t uint64;
+#else
+#include <cytypes.h>
+#endif
+
+#define SIPHASH_KEY_LEN     (16u)
+
+uint64 SipHash_24(const uint8 key[SIPHASH_KEY_LEN], const uint8 data[], uint8 len);
+
+#endif /* SIPHASH_H */
+
+/* [] END OF FILE */
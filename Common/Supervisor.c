@@ -0,0 +1,173 @@
+/* ========================================
+ * Air Quality Beacon, part of the hackAIR project.
+ * Freely available under CC BY 4.0
+ *
+ * http://www.hackair.eu/
+*/
+#include "Supervisor.h"
+#include "LpTimer.h"
+
+#define SUPERVISOR_MAGIC    (0x53555056u) // "SUPV", no-init record is valid
+
+/* Kept across resets, not cleared by the startup code */
+typedef struct
+{
+    uint32 magic;
+    uint8  current;     // Stage running right now
+    uint8  lastFault;   // Stage that caused the last supervised reset
+    uint8  faults;      // Supervised resets since power up
+} SUPERVISOR_RECORD_T;
+
+static SUPERVISOR_RECORD_T record CY_NOINIT;
+
+static uint32 deadline[SUPERVISOR_STAGES]; // LF ticks
+static volatile uint32 stageStart;
+static volatile uint32 lastKick;
+static uint32 maxTicks[SUPERVISOR_STAGES];
+static uint32 sumTicks[SUPERVISOR_STAGES];
+static uint16 runs[SUPERVISOR_STAGES];
+
+/*******************************************************************
+* NAME :            void Supervisor_Check()
+*
+* DESCRIPTION :     WDT counter 1 callback, interrupt context.
+*                   Resets the device if the running stage is past
+*                   its deadline or the loop stopped checking in.
+*                   Returning clears the interrupt, which feeds the
+*                   hardware watchdog.
+*/
+static void Supervisor_Check(void){
+    uint32 now = LpTimer_Now();
+    uint8 stage = record.current;
+    
+    if((stage < SUPERVISOR_STAGES) && ((now - stageStart) > deadline[stage])){
+        record.lastFault = stage;
+        if(record.faults < 0xFFu) record.faults++;
+        CySoftwareReset(); // Stage can't be aborted from here, start over
+    }
+    if((now - lastKick) > SUPERVISOR_KICK_TICKS){ // Hung outside the stages (task, sleep, calibration)
+        record.lastFault = SUPERVISOR_STAGE_LOOP;
+        if(record.faults < 0xFFu) record.faults++;
+        CySoftwareReset(); // Stage can't be aborted from here, start over
+    }
+}
+
+/*******************************************************************
+* NAME :            void Supervisor_Start(const uint32 deadlineMs[])
+*
+* DESCRIPTION :     Pick up the record of the previous run and
+*                   start the watchdog
+* INPUTS :
+*       const uint32 deadlineMs[]   Deadline per stage in ms
+*/
+void Supervisor_Start(const uint32 deadlineMs[SUPERVISOR_STAGES]){
+    uint32 reason = CySysGetResetReason(CY_SYS_RESET_WDT | CY_SYS_RESET_SW);
+    uint8 i;
+    
+    if(record.magic != SUPERVISOR_MAGIC){ // Power up, RAM content is random
+        record.magic = SUPERVISOR_MAGIC;
+        record.lastFault = SUPERVISOR_STAGE_NONE;
+        record.faults = 0u;
+    }else if((reason & CY_SYS_RESET_WDT) != 0u){
+        record.lastFault = record.current; // Hardware watchdog, interrupts were stuck
+        if(record.faults < 0xFFu) record.faults++;
+    }
+    record.current = SUPERVISOR_STAGE_NONE;
+    
+    for(i = 0u; i < SUPERVISOR_STAGES; i++) deadline[i] = LpTimer_MsToTicks(deadlineMs[i]);
+    Supervisor_ResetStats();
+    lastKick = LpTimer_Now();
+    
+    CySysWdtSetMode(SUPERVISOR_COUNTER, CY_SYS_WDT_MODE_INT_RESET);
+    CySysWdtSetClearOnMatch(SUPERVISOR_COUNTER, 1u);
+    CySysWdtSetMatch(SUPERVISOR_COUNTER, SUPERVISOR_CHECK_TICKS);
+    CySysWdtSetInterruptCallback(SUPERVISOR_COUNTER, Supervisor_Check);
+    CySysWdtEnableCounterIsr(SUPERVISOR_COUNTER);
+    CySysWdtEnable(SUPERVISOR_COUNTER_MASK);
+    CyIntEnable(LPTIMER_WDT_IRQ);
+}
+
+void Supervisor_Begin(uint8 stage){
+    stageStart = LpTimer_Now();
+    record.current = stage;
+}
+
+/*******************************************************************
+* NAME :            void Supervisor_Kick()
+*
+* DESCRIPTION :     Main loop check-in, call once per iteration and
+*                   from any loop that runs on its own for longer
+*                   than a check period
+*/
+void Supervisor_Kick(void){
+    lastKick = LpTimer_Now();
+}
+
+/*******************************************************************
+* NAME :            void Supervisor_End()
+*
+* DESCRIPTION :     Close the running stage and add its latency to
+*                   the stage statistics
+*/
+void Supervisor_End(void){
+    uint8 stage = record.current;
+    uint32 t = LpTimer_Now() - stageStart;
+    
+    record.current = SUPERVISOR_STAGE_NONE;
+    if(stage >= SUPERVISOR_STAGES) return;
+    if(t > maxTicks[stage]) maxTicks[stage] = t;
+    if(runs[stage] < 0xFFFFu){
+        sumTicks[stage] += t;
+        runs[stage]++;
+    }
+}
+
+uint8 Supervisor_LastFault(void){
+    return record.lastFault;
+}
+
+uint32 Supervisor_MaxTicks(uint8 stage){
+    return (stage < SUPERVISOR_STAGES) ? maxTicks[stage] : 0u;
+}
+
+uint32 Supervisor_MeanTicks(uint8 stage){
+    return ((stage < SUPERVISOR_STAGES) && (runs[stage] != 0u)) ? (sumTicks[stage] / runs[stage]) : 0u;
+}
+
+void Supervisor_ResetStats(void){
+    uint8 i;
+    
+    for(i = 0u; i < SUPERVISOR_STAGES; i++){
+        maxTicks[i] = 0u;
+        sumTicks[i] = 0u;
+        runs[i] = 0u;
+    }
+}
+
+/*******************************************************************
+* NAME :            void Supervisor_WriteFrame(uint8 frame[])
+*
+* DESCRIPTION :     Pack the supervisor state for the advertisement.
+*                   Latencies are in 8 LF tick (~0.25ms) steps,
+*                   saturated at 255.
+*                   frame[0]   Last faulted stage + 1 (high nibble,
+*                              0 = none, 4 = loop check-in), fault
+*                              count (low nibble)
+*                   frame[1-2] BLE max, mean
+*                   frame[3-4] Sensor max, mean
+*                   frame[5-6] Payload max, mean
+*/
+void Supervisor_WriteFrame(uint8 frame[]){
+    uint8 fault = (record.lastFault <= SUPERVISOR_STAGE_LOOP) ? (record.lastFault + 1u) : 0u;
+    uint8 i;
+    
+    frame[0] = (uint8)((fault << 4) | ((record.faults > 0x0Fu) ? 0x0Fu : record.faults));
+    for(i = 0u; i < SUPERVISOR_STAGES; i++){
+        uint32 mx = Supervisor_MaxTicks(i) >> 3;
+        uint32 mean = Supervisor_MeanTicks(i) >> 3;
+        frame[1u + (2u * i)] = (mx > 0xFFu) ? 0xFFu : (uint8)mx;
+        frame[2u + (2u * i)] = (mean > 0xFFu) ? 0xFFu : (uint8)mean;
+    }
+}
+
+/* [] END OF FILE */
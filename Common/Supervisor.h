@@ -0,0 +1,53 @@
+/* ========================================
+ * Air Quality Beacon, part of the hackAIR project.
+ * Freely available under CC BY 4.0
+ *
+ * Main loop supervision shared by all sensor firmwares.
+ * Every stage of the loop (BLE processing, sensor read, payload
+ * update) is bracketed with Supervisor_Begin()/Supervisor_End().
+ * WDT counter 1 runs in watchdog with interrupt mode: its interrupt
+ * checks the running stage against its deadline and resets the
+ * device on overrun, and if interrupts are stuck the unserviced
+ * match resets it in hardware. The stage that was running survives
+ * the reset in no-init RAM.
+ * Code outside the stages is covered by Supervisor_Kick(), called
+ * once per loop iteration: the interrupt stops feeding the watchdog
+ * once the last check-in is older than SUPERVISOR_KICK_TICKS. Every
+ * check interrupt wakes the loop from sleep, so an idle loop checks
+ * in at least once per SUPERVISOR_CHECK_TICKS.
+ *
+ * http://www.hackair.eu/
+*/
+#ifndef SUPERVISOR_H
+#define SUPERVISOR_H
+
+#include <project.h>
+
+#define SUPERVISOR_STAGE_BLE        (0u)
+#define SUPERVISOR_STAGE_SENSOR     (1u)
+#define SUPERVISOR_STAGE_PAYLOAD    (2u)
+#define SUPERVISOR_STAGES           (3u)
+#define SUPERVISOR_STAGE_LOOP       (3u)        // Fault only, the loop stopped checking in
+#define SUPERVISOR_STAGE_NONE       (0xFFu)
+
+#define SUPERVISOR_COUNTER          (CY_SYS_WDT_COUNTER1)
+#define SUPERVISOR_COUNTER_MASK     (CY_SYS_WDT_COUNTER1_MASK)
+#define SUPERVISOR_CHECK_TICKS      (0xFFFFu)   // ~2s between deadline checks, 16 bit counter
+#define SUPERVISOR_KICK_TICKS       (2u * SUPERVISOR_CHECK_TICKS) // Stale loop check-in, ~4s
+
+#define SUPERVISOR_FRAME_LEN        (7u)        // Bytes written by Supervisor_WriteFrame()
+
+void Supervisor_Start(const uint32 deadlineMs[SUPERVISOR_STAGES]);
+void Supervisor_Begin(uint8 stage);
+void Supervisor_End(void);
+void Supervisor_Kick(void);
+
+uint8 Supervisor_LastFault(void);
+uint32 Supervisor_MaxTicks(uint8 stage);
+uint32 Supervisor_MeanTicks(uint8 stage);
+void Supervisor_ResetStats(void);
+void Supervisor_WriteFrame(uint8 frame[]);
+
+#endif /* SUPERVISOR_H */
+
+/* [] END OF FILE */
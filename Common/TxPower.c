@@ -0,0 +1,70 @@
+/* ========================================
+ * Air Quality Beacon, part of the hackAIR project.
+ * Freely available under CC BY 4.0
+ *
+ * http://www.hackair.eu/
+*/
+#include "TxPower.h"
+
+/* Output power and typical TX current per level, from TXPOWER_LEVEL_MIN */
+static const int8 dbm[TXPOWER_LEVEL_MAX] = {-18, -12, -6, -3, -2, -1, 0, 3};
+static const uint16 txCurrent[TXPOWER_LEVEL_MAX] = {3400u, 3700u, 4200u, 4700u, 4900u, 5200u, 5600u, 6700u};
+
+/* Table index, out of range levels clamp */
+static uint8 levelIndex(uint8 level){
+    if(level < TXPOWER_LEVEL_MIN) level = TXPOWER_LEVEL_MIN;
+    if(level > TXPOWER_LEVEL_MAX) level = TXPOWER_LEVEL_MAX;
+    return (uint8)(level - TXPOWER_LEVEL_MIN);
+}
+
+/*******************************************************************
+* NAME :            uint8 TxPower_Level(uint8 config, uint8 burst)
+*
+* DESCRIPTION :     Level to advertise at
+* INPUTS :
+*       uint8 config    TXPOWER_CONFIG
+*       uint8 burst     1 while the cadence is in a burst
+* OUTPUTS :
+*       uint8 CYBLE_BLESS_PWR_LVL_T level
+*/
+uint8 TxPower_Level(uint8 config, uint8 burst){
+    uint8 level = config & 0x0Fu;
+    
+    if(burst && ((config >> 4) != 0u)) level = (uint8)(config >> 4);
+    if(level == 0u) return TXPOWER_LEVEL_0DBM;
+    return (level > TXPOWER_LEVEL_MAX) ? TXPOWER_LEVEL_MAX : level;
+}
+
+int8 TxPower_Dbm(uint8 level){
+    return dbm[levelIndex(level)];
+}
+
+/*******************************************************************
+* NAME :            uint8 TxPower_LevelOf(int8 power)
+*
+* DESCRIPTION :     Highest level not above an advertised power,
+*                   for receivers
+*/
+uint8 TxPower_LevelOf(int8 power){
+    uint8 level = TXPOWER_LEVEL_MIN;
+    
+    while((level < TXPOWER_LEVEL_MAX) && (dbm[levelIndex(level + 1u)] <= power)) level++;
+    return level;
+}
+
+uint16 TxPower_CurrentUA(uint8 level){
+    return txCurrent[levelIndex(level)];
+}
+
+/*******************************************************************
+* NAME :            uint16 TxPower_RadioPermille(uint8 level)
+*
+* DESCRIPTION :     Advertising event charge at a level relative to
+*                   0dBm, for Energy_ScaleLoad()
+*/
+uint16 TxPower_RadioPermille(uint8 level){
+    return (uint16)((1000u - TXPOWER_TX_SHARE) +
+        (((uint32)TXPOWER_TX_SHARE * txCurrent[levelIndex(level)]) / txCurrent[levelIndex(TXPOWER_LEVEL_0DBM)]));
+}
+
+/* [] END OF FILE */
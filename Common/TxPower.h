@@ -0,0 +1,48 @@
+/* ========================================
+ * Air Quality Beacon, part of the hackAIR project.
+ * Freely available under CC BY 4.0
+ *
+ * Advertising TX power policy and current model, shared by all
+ * sensor firmwares and by receivers. Units next to their gateway
+ * can run at -18dBm, remote ones at +3dBm. The level comes from
+ * byte 1 of SFLASH user row 0, one CYBLE_BLESS_PWR_LVL_T level per
+ * nibble, 0 keeps the 0dBm of the BLE component:
+ *
+ *   [3:0]   Level between bursts
+ *   [7:4]   Level during a burst, so a spike reaches further
+ *
+ * The model scales the radio load of the energy report: part of an
+ * advertising event is spent on the ECO start and the receive
+ * windows, only the rest follows the TX current of the level.
+ * No hardware access. Build with HACKAIR_HOST to use it on a PC.
+ *
+ * http://www.hackair.eu/
+*/
+#ifndef TXPOWER_H
+#define TXPOWER_H
+
+#ifdef HACKAIR_HOST
+#include <stdint.h>
+typedef uint8_t uint8;
+typedef uint16_t uint16;
+typedef uint32_t uint32;
+typedef int8_t int8;
+#else
+#include <project.h>
+#define TXPOWER_CONFIG          (*(reg8 *)(CY_SFLASH_USERBASE + 1u))
+#endif
+
+#define TXPOWER_LEVEL_MIN       (1u)    // -18dBm
+#define TXPOWER_LEVEL_0DBM      (7u)
+#define TXPOWER_LEVEL_MAX       (8u)    // +3dBm
+#define TXPOWER_TX_SHARE        (600u)  // Permille of the event charge spent transmitting at 0dBm
+
+uint8 TxPower_Level(uint8 config, uint8 burst);
+int8 TxPower_Dbm(uint8 level);
+uint8 TxPower_LevelOf(int8 power);
+uint16 TxPower_CurrentUA(uint8 level);
+uint16 TxPower_RadioPermille(uint8 level);
+
+#endif /* TXPOWER_H */
+
+/* [] END OF FILE */
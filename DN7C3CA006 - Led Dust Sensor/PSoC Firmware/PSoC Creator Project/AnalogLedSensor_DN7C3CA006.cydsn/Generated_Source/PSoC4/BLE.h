@@ -67,7 +67,7 @@ the software package with which this file was provided.
 
 #if(CYBLE_MODE_PROFILE)
     
-#define CYBLE_GAP_ROLE                              (0x04u)
+#define CYBLE_GAP_ROLE                              (0x05u)
 #define CYBLE_GAP_HCI                               (0x00u)
 #define CYBLE_GAP_PERIPHERAL                        (0x01u)
 #define CYBLE_GAP_CENTRAL                           (0x02u)
@@ -138,7 +138,7 @@ the software package with which this file was provided.
 #define CYBLE_L2CAP_HEADER_SIZE                     (4u)
 
 /* GATT MTU Size */
-#define CYBLE_GATT_MTU                              (0x0017u)
+#define CYBLE_GATT_MTU                              (0x00F7u)
 #define CYBLE_GATT_MTU_PLUS_L2CAP_HEADER            (CYBLE_GATT_MTU + CYBLE_L2CAP_HEADER_SIZE)
 
 /* Stack buffers count */
@@ -146,7 +146,7 @@ the software package with which this file was provided.
 #define CYBLE_STACK_BUF_COUNT                       (6u)
 
 /* GATT Maximum attribute length */
-#define CYBLE_GATT_MAX_ATTR_LEN                     (0x000Au)
+#define CYBLE_GATT_MAX_ATTR_LEN                     (0x0014u)
 
 /* L2CAP MTU Size */
 #define CYBLE_L2CAP_MTU                             (23u)
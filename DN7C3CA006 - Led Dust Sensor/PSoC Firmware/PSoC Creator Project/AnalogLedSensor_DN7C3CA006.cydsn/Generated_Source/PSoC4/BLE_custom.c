@@ -29,13 +29,33 @@ const CYBLE_CUSTOMS_T cyBle_customs[0x01u] = {
         0x000Au, /* Handle of the Custom Service service */ 
         {
 
-            /* Custom Characteristic characteristic */
+            /* History characteristic */
             {
-                0x000Cu, /* Handle of the Custom Characteristic characteristic */ 
+                0x000Cu, /* Handle of the History characteristic */ 
                 
                 /* Array of Descriptors handles */
                 {
-                    0x000Du, /* Handle of the Custom Descriptor descriptor */ 
+                    0x000Du, /* Handle of the Client Characteristic Configuration descriptor */ 
+                }, 
+            },
+
+            /* Live Stream characteristic */
+            {
+                0x000Fu, /* Handle of the Live Stream characteristic */ 
+                
+                /* Array of Descriptors handles */
+                {
+                    0x0010u, /* Handle of the Client Characteristic Configuration descriptor */ 
+                }, 
+            },
+
+            /* Config characteristic */
+            {
+                0x0012u, /* Handle of the Config characteristic */ 
+                
+                /* Array of Descriptors handles */
+                {
+                    CYBLE_GATT_INVALID_ATTR_HANDLE_VALUE, 
                 }, 
             },
         }, 
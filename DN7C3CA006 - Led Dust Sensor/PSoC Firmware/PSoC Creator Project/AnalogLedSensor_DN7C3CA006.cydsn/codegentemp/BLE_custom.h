@@ -26,18 +26,24 @@ the software package with which this file was provided.
 /* Maximum supported Custom Services */
 #define CYBLE_CUSTOMS_SERVICE_COUNT                  (0x01u)
 #define CYBLE_CUSTOMC_SERVICE_COUNT                  (0x00u)
-#define CYBLE_CUSTOM_SERVICE_CHAR_COUNT              (0x01u)
+#define CYBLE_CUSTOM_SERVICE_CHAR_COUNT              (0x03u)
 #define CYBLE_CUSTOM_SERVICE_CHAR_DESCRIPTORS_COUNT  (0x01u)
 
 /* Below are the indexes and handles of the defined Custom Services and their characteristics */
 #define CYBLE_CUSTOM_SERVICE_SERVICE_INDEX   (0x00u) /* Index of Custom Service service in the cyBle_customs array */
-#define CYBLE_CUSTOM_SERVICE_CUSTOM_CHARACTERISTIC_CHAR_INDEX   (0x00u) /* Index of Custom Characteristic characteristic */
-#define CYBLE_CUSTOM_SERVICE_CUSTOM_CHARACTERISTIC_CUSTOM_DESCRIPTOR_DESC_INDEX   (0x00u) /* Index of Custom Descriptor descriptor */
+#define CYBLE_CUSTOM_SERVICE_HISTORY_CHAR_INDEX   (0x00u) /* Index of History characteristic */
+#define CYBLE_CUSTOM_SERVICE_HISTORY_CLIENT_CHARACTERISTIC_CONFIGURATION_DESC_INDEX   (0x00u) /* Index of Client Characteristic Configuration descriptor */
+#define CYBLE_CUSTOM_SERVICE_LIVE_STREAM_CHAR_INDEX   (0x01u) /* Index of Live Stream characteristic */
+#define CYBLE_CUSTOM_SERVICE_LIVE_STREAM_CLIENT_CHARACTERISTIC_CONFIGURATION_DESC_INDEX   (0x00u) /* Index of Client Characteristic Configuration descriptor */
+#define CYBLE_CUSTOM_SERVICE_CONFIG_CHAR_INDEX   (0x02u) /* Index of Config characteristic */
 
 
 #define CYBLE_CUSTOM_SERVICE_SERVICE_HANDLE   (0x000Au) /* Handle of Custom Service service */
-#define CYBLE_CUSTOM_SERVICE_CUSTOM_CHARACTERISTIC_CHAR_HANDLE   (0x000Cu) /* Handle of Custom Characteristic characteristic */
-#define CYBLE_CUSTOM_SERVICE_CUSTOM_CHARACTERISTIC_CUSTOM_DESCRIPTOR_DESC_HANDLE   (0x000Du) /* Handle of Custom Descriptor descriptor */
+#define CYBLE_CUSTOM_SERVICE_HISTORY_CHAR_HANDLE   (0x000Cu) /* Handle of History characteristic */
+#define CYBLE_CUSTOM_SERVICE_HISTORY_CLIENT_CHARACTERISTIC_CONFIGURATION_DESC_HANDLE   (0x000Du) /* Handle of Client Characteristic Configuration descriptor */
+#define CYBLE_CUSTOM_SERVICE_LIVE_STREAM_CHAR_HANDLE   (0x000Fu) /* Handle of Live Stream characteristic */
+#define CYBLE_CUSTOM_SERVICE_LIVE_STREAM_CLIENT_CHARACTERISTIC_CONFIGURATION_DESC_HANDLE   (0x0010u) /* Handle of Client Characteristic Configuration descriptor */
+#define CYBLE_CUSTOM_SERVICE_CONFIG_CHAR_HANDLE   (0x0012u) /* Handle of Config characteristic */
 
 
 
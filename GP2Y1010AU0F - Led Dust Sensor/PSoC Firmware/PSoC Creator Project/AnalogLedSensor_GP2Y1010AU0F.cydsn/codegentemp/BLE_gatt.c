@@ -32,7 +32,7 @@ CYBLE_STATE_T cyBle_state;
     0x0009u,    /* Handle of the Client Characteristic Configuration descriptor */
 };
     
-    static uint8 cyBle_attValues[0x22u] = {
+    static uint8 cyBle_attValues[0x2Bu] = {
     /* Device Name */
     (uint8)'A', (uint8)'i', (uint8)'r', (uint8)' ', (uint8)'B', (uint8)'e', (uint8)'a', (uint8)'c', (uint8)'o', (uint8)'n', 
 
@@ -42,11 +42,14 @@ CYBLE_STATE_T cyBle_state;
     /* Service Changed */
     0x00u, 0x00u, 0x00u, 0x00u, 
 
-    /* Custom Characteristic */
-    0x00u, 
+    /* History */
+    0x00u, 0x00u, 0x00u, 0x00u, 
+
+    /* Live Stream */
+    0x00u, 0x00u, 0x00u, 
 
-    /* Custom Descriptor */
-    0x00u, 0xFBu, 0x34u, 0x9Bu, 0x5Fu, 0x80u, 0x00u, 0x00u, 0x80u, 0x00u, 0x10u, 0x00u, 0x00u, 0x00u, 0x00u, 0x00u, 0x00u, 
+    /* Config */
+    0x00u, 0x00u, 0x00u, 0x00u, 0x00u, 0x00u, 0x00u, 0x00u, 0x00u, 0x00u, 0x00u, 0x00u, 0x00u, 0x00u, 0x00u, 0x00u, 0x00u, 0x00u, 0x00u, 0x00u, 
 
 };
 
@@ -58,28 +61,32 @@ const uint8 cyBle_attValuesCCCDFlashMemory[CYBLE_GAP_MAX_BONDED_DEVICE + 1u][CYB
 const uint8 cyBle_attValuesCCCDFlashMemory[CYBLE_GAP_MAX_BONDED_DEVICE + 1u][CYBLE_GATT_DB_CCCD_COUNT] = {
 #endif /* defined(__GNUC__) || defined(__ARMCC_VERSION) */
 {
-    0x00u, 0x00u, 
+    0x00u, 0x00u, 0x00u, 0x00u, 0x00u, 0x00u, 
 },
 {
-    0x00u, 0x00u, 
+    0x00u, 0x00u, 0x00u, 0x00u, 0x00u, 0x00u, 
 },
 {
-    0x00u, 0x00u, 
+    0x00u, 0x00u, 0x00u, 0x00u, 0x00u, 0x00u, 
 },
 {
-    0x00u, 0x00u, 
+    0x00u, 0x00u, 0x00u, 0x00u, 0x00u, 0x00u, 
 },
 {
-    0x00u, 0x00u, 
+    0x00u, 0x00u, 0x00u, 0x00u, 0x00u, 0x00u, 
 },
 };
 uint8 cyBle_attValuesCCCD[CYBLE_GATT_DB_CCCD_COUNT];
 
 const uint8 cyBle_attUuid128[][16u] = {
     /* Custom Service */
-    { 0xFBu, 0x34u, 0x9Bu, 0x5Fu, 0x80u, 0x00u, 0x00u, 0x80u, 0x00u, 0x10u, 0x00u, 0x00u, 0x00u, 0x00u, 0x00u, 0x00u },
-    /* Custom Characteristic */
-    { 0xFBu, 0x34u, 0x9Bu, 0x5Fu, 0x80u, 0x00u, 0x00u, 0x80u, 0x00u, 0x10u, 0x00u, 0x00u, 0x00u, 0x00u, 0x00u, 0x00u },
+    { 0x00u, 0x00u, 0x00u, 0x00u, 0x00u, 0x00u, 0x00u, 0x80u, 0x00u, 0x52u, 0x49u, 0x41u, 0x6Bu, 0x63u, 0x61u, 0x48u },
+    /* History */
+    { 0x01u, 0x00u, 0x00u, 0x00u, 0x00u, 0x00u, 0x00u, 0x80u, 0x00u, 0x52u, 0x49u, 0x41u, 0x6Bu, 0x63u, 0x61u, 0x48u },
+    /* Live Stream */
+    { 0x02u, 0x00u, 0x00u, 0x00u, 0x00u, 0x00u, 0x00u, 0x80u, 0x00u, 0x52u, 0x49u, 0x41u, 0x6Bu, 0x63u, 0x61u, 0x48u },
+    /* Config */
+    { 0x03u, 0x00u, 0x00u, 0x00u, 0x00u, 0x00u, 0x00u, 0x80u, 0x00u, 0x52u, 0x49u, 0x41u, 0x6Bu, 0x63u, 0x61u, 0x48u },
 };
 
 CYBLE_GATTS_ATT_GEN_VAL_LEN_T cyBle_attValuesLen[CYBLE_GATT_DB_ATT_VAL_COUNT] = {
@@ -88,25 +95,35 @@ CYBLE_GATTS_ATT_GEN_VAL_LEN_T cyBle_attValuesLen[CYBLE_GATT_DB_ATT_VAL_COUNT] =
     { 0x0004u, (void *)&cyBle_attValues[12] }, /* Service Changed */
     { 0x0002u, (void *)&cyBle_attValuesCCCD[0] }, /* Client Characteristic Configuration */
     { 0x0010u, (void *)&cyBle_attUuid128[0] }, /* Custom Service UUID */
-    { 0x0010u, (void *)&cyBle_attUuid128[1] }, /* Custom Characteristic UUID */
-    { 0x0001u, (void *)&cyBle_attValues[16] }, /* Custom Characteristic */
-    { 0x0011u, (void *)&cyBle_attValues[17] }, /* Custom Descriptor */
+    { 0x0010u, (void *)&cyBle_attUuid128[1] }, /* History UUID */
+    { 0x0004u, (void *)&cyBle_attValues[16] }, /* History */
+    { 0x0002u, (void *)&cyBle_attValuesCCCD[2] }, /* Client Characteristic Configuration */
+    { 0x0010u, (void *)&cyBle_attUuid128[2] }, /* Live Stream UUID */
+    { 0x0003u, (void *)&cyBle_attValues[20] }, /* Live Stream */
+    { 0x0002u, (void *)&cyBle_attValuesCCCD[4] }, /* Client Characteristic Configuration */
+    { 0x0010u, (void *)&cyBle_attUuid128[3] }, /* Config UUID */
+    { 0x0014u, (void *)&cyBle_attValues[23] }, /* Config */
 };
 
-const CYBLE_GATTS_DB_T cyBle_gattDB[0x0Du] = {
-    { 0x0001u, 0x2800u /* Primary service                     */, 0x00000001u /*        */, 0x0005u, {{0x1800u, NULL}}                           },
-    { 0x0002u, 0x2803u /* Characteristic                      */, 0x00000201u /* rd     */, 0x0003u, {{0x2A00u, NULL}}                           },
-    { 0x0003u, 0x2A00u /* Device Name                         */, 0x00000201u /* rd     */, 0x0003u, {{0x000Au, (void *)&cyBle_attValuesLen[0]}} },
-    { 0x0004u, 0x2803u /* Characteristic                      */, 0x00000201u /* rd     */, 0x0005u, {{0x2A01u, NULL}}                           },
-    { 0x0005u, 0x2A01u /* Appearance                          */, 0x00000201u /* rd     */, 0x0005u, {{0x0002u, (void *)&cyBle_attValuesLen[1]}} },
-    { 0x0006u, 0x2800u /* Primary service                     */, 0x00000001u /*        */, 0x0009u, {{0x1801u, NULL}}                           },
-    { 0x0007u, 0x2803u /* Characteristic                      */, 0x00002201u /* rd,ind */, 0x0009u, {{0x2A05u, NULL}}                           },
-    { 0x0008u, 0x2A05u /* Service Changed                     */, 0x00002201u /* rd,ind */, 0x0009u, {{0x0004u, (void *)&cyBle_attValuesLen[2]}} },
-    { 0x0009u, 0x2902u /* Client Characteristic Configuration */, 0x00000A04u /* rd,wr  */, 0x0009u, {{0x0002u, (void *)&cyBle_attValuesLen[3]}} },
-    { 0x000Au, 0x2800u /* Primary service                     */, 0x00080001u /*        */, 0x000Du, {{0x0010u, (void *)&cyBle_attValuesLen[4]}} },
-    { 0x000Bu, 0x2803u /* Characteristic                      */, 0x00000001u /*        */, 0x000Du, {{0x0010u, (void *)&cyBle_attValuesLen[5]}} },
-    { 0x000Cu, 0x0000u /* Custom Characteristic               */, 0x00080000u /*        */, 0x000Du, {{0x0001u, (void *)&cyBle_attValuesLen[6]}} },
-    { 0x000Du, 0x0000u /* Custom Descriptor                   */, 0x00080001u /*        */, 0x000Du, {{0x0001u, (void *)&cyBle_attValuesLen[7]}} },
+const CYBLE_GATTS_DB_T cyBle_gattDB[0x12u] = {
+    { 0x0001u, 0x2800u /* Primary service                     */, 0x00000001u /*        */, 0x0005u, {{0x1800u, NULL}}                            },
+    { 0x0002u, 0x2803u /* Characteristic                      */, 0x00000201u /* rd     */, 0x0003u, {{0x2A00u, NULL}}                            },
+    { 0x0003u, 0x2A00u /* Device Name                         */, 0x00000201u /* rd     */, 0x0003u, {{0x000Au, (void *)&cyBle_attValuesLen[0]}}  },
+    { 0x0004u, 0x2803u /* Characteristic                      */, 0x00000201u /* rd     */, 0x0005u, {{0x2A01u, NULL}}                            },
+    { 0x0005u, 0x2A01u /* Appearance                          */, 0x00000201u /* rd     */, 0x0005u, {{0x0002u, (void *)&cyBle_attValuesLen[1]}}  },
+    { 0x0006u, 0x2800u /* Primary service                     */, 0x00000001u /*        */, 0x0009u, {{0x1801u, NULL}}                            },
+    { 0x0007u, 0x2803u /* Characteristic                      */, 0x00002201u /* rd,ind */, 0x0009u, {{0x2A05u, NULL}}                            },
+    { 0x0008u, 0x2A05u /* Service Changed                     */, 0x00002201u /* rd,ind */, 0x0009u, {{0x0004u, (void *)&cyBle_attValuesLen[2]}}  },
+    { 0x0009u, 0x2902u /* Client Characteristic Configuration */, 0x00000A04u /* rd,wr  */, 0x0009u, {{0x0002u, (void *)&cyBle_attValuesLen[3]}}  },
+    { 0x000Au, 0x2800u /* Primary service                     */, 0x00080001u /*        */, 0x0012u, {{0x0010u, (void *)&cyBle_attValuesLen[4]}}  },
+    { 0x000Bu, 0x2803u /* Characteristic                      */, 0x00001801u /* wr,ntf */, 0x000Du, {{0x0010u, (void *)&cyBle_attValuesLen[5]}}  },
+    { 0x000Cu, 0x0000u /* History                             */, 0x00081802u /* wr,ntf */, 0x000Du, {{0x0004u, (void *)&cyBle_attValuesLen[6]}}  },
+    { 0x000Du, 0x2902u /* Client Characteristic Configuration */, 0x00000A04u /* rd,wr  */, 0x000Du, {{0x0002u, (void *)&cyBle_attValuesLen[7]}}  },
+    { 0x000Eu, 0x2803u /* Characteristic                      */, 0x00001801u /* wr,ntf */, 0x0010u, {{0x0010u, (void *)&cyBle_attValuesLen[8]}}  },
+    { 0x000Fu, 0x0000u /* Live Stream                         */, 0x00081802u /* wr,ntf */, 0x0010u, {{0x0003u, (void *)&cyBle_attValuesLen[9]}}  },
+    { 0x0010u, 0x2902u /* Client Characteristic Configuration */, 0x00000A04u /* rd,wr  */, 0x0010u, {{0x0002u, (void *)&cyBle_attValuesLen[10]}} },
+    { 0x0011u, 0x2803u /* Characteristic                      */, 0x00000A01u /* rd,wr  */, 0x0012u, {{0x0010u, (void *)&cyBle_attValuesLen[11]}} },
+    { 0x0012u, 0x0000u /* Config                              */, 0x00080A04u /* rd,wr  */, 0x0012u, {{0x0014u, (void *)&cyBle_attValuesLen[12]}} },
 };
 
 
@@ -35,13 +35,13 @@
 
 #if(CYBLE_GATT_ROLE_SERVER)
 
-#define CYBLE_GATT_DB_INDEX_COUNT                    (0x000Du)
-#define CYBLE_GATT_DB_ATT_VAL_COUNT                  (0x08u)
-#define CYBLE_GATT_DB_MAX_VALUE_LEN                  (0x000Au)
+#define CYBLE_GATT_DB_INDEX_COUNT                    (0x0012u)
+#define CYBLE_GATT_DB_ATT_VAL_COUNT                  (0x0Du)
+#define CYBLE_GATT_DB_MAX_VALUE_LEN                  (0x0014u)
 
 #endif /* CYBLE_GATT_ROLE_SERVER */
 
-#define CYBLE_GATT_DB_CCCD_COUNT                     (0x02u)
+#define CYBLE_GATT_DB_CCCD_COUNT                     (0x06u)
 
 #if (CYBLE_GATT_DB_CCCD_COUNT == 0u)
     #define CYBLE_GATT_DB_FLASH_CCCD_COUNT          (1u)
@@ -49,6 +49,9 @@
     #define CYBLE_GATT_DB_FLASH_CCCD_COUNT          (CYBLE_GATT_DB_CCCD_COUNT)
 #endif
 
+#define CYBLE_CUSTOM
+#define CYBLE_CUSTOM_SERVER
+
 
 
 
@@ -0,0 +1,165 @@
+/* ========================================
+ * Air Quality Beacon, part of the hackAIR project.
+ * Freely available under CC BY 4.0
+ *
+ * http://www.hackair.eu/
+*/
+#include "PulseCapture.h"
+#include "LpTimer.h"
+#include "LiveStream.h"
+#include "Settings.h"
+
+static volatile uint32 lowTicks;     // Accumulated low time in current window
+static volatile uint32 lowStart;     // Timestamp of the last falling edge
+static volatile uint8  inLow;        // Input currently low
+static volatile uint8  histEnabled;
+static volatile uint16 hist[PULSECAPTURE_HIST_BINS];
+static volatile uint16 histPulses;   // Pulses binned since last read
+static uint32 windowStart;
+
+/*******************************************************************
+* NAME :            CY_ISR(PulseCapture_Isr)
+*
+* DESCRIPTION :     PWM_IN edge interrupt. Constant work per edge:
+*                   one timestamp, one add, at most BINS-1 shifts and
+*                   a live stream sample.
+*/
+static CY_ISR(PulseCapture_Isr){
+    uint32 now = LpTimer_Now();
+    
+    PWM_IN_ClearInterrupt();
+    if(PWM_IN_Read() == 0u){ // Falling edge, pulse starts
+        lowStart = now;
+        inLow = 1u;
+    }else if(inLow != 0u){ // Rising edge, pulse ends
+        uint32 width = now - lowStart;
+        lowTicks += width;
+        inLow = 0u;
+        LiveStream_PutU16((width > 0xFFFFu) ? 0xFFFFu : (uint16)width); // Queued or dropped, never waits
+        
+        if(histEnabled != 0u){
+            uint32 w = width >> PULSECAPTURE_HIST_BASE_SHIFT;
+            uint8 bin = 0u;
+            while((w > 1u) && (bin < (PULSECAPTURE_HIST_BINS - 1u))){
+                w >>= 1;
+                bin++;
+            }
+            if(hist[bin] != 0xFFFFu) hist[bin]++;
+            if(histPulses != 0xFFFFu) histPulses++;
+        }
+    }
+}
+
+/*******************************************************************
+* NAME :            void PulseCapture_Start()
+*
+* DESCRIPTION :     Enable edge capture on PWM_IN. The histogram is
+*                   switched on if the unit's diagnostics flag is set.
+*/
+void PulseCapture_Start(void){
+    LpTimer_Start();
+    histEnabled = ((SETTINGS_FLAGS & SETTINGS_FLAG_HISTOGRAM) != 0u) ? 1u : 0u;
+    inLow = (PWM_IN_Read() == 0u) ? 1u : 0u;
+    lowStart = LpTimer_Now();
+    
+    PWM_IN_SetInterruptMode(PWM_IN_INTR_ALL, PWM_IN_INTR_BOTH);
+    (void)PWM_IN_ClearInterrupt();
+    (void)CyIntSetVector(PULSECAPTURE_IRQ, &PulseCapture_Isr);
+    CyIntSetPriority(PULSECAPTURE_IRQ, PULSECAPTURE_IRQ_PRIORITY);
+    CyIntEnable(PULSECAPTURE_IRQ);
+}
+
+/*******************************************************************
+* NAME :            void PulseCapture_BeginWindow()
+*
+* DESCRIPTION :     Start a new LPO measurement window
+*/
+void PulseCapture_BeginWindow(void){
+    uint8 intState = CyEnterCriticalSection();
+    windowStart = LpTimer_Now();
+    lowTicks = 0u;
+    if(inLow != 0u) lowStart = windowStart; // Count a running pulse from here
+    CyExitCriticalSection(intState);
+}
+
+/*******************************************************************
+* NAME :            uint8 PulseCapture_EndWindow()
+*
+* DESCRIPTION :     Close the LPO measurement window
+* OUTPUTS :
+*       uint8 Low pulse occupancy in percent
+*/
+uint8 PulseCapture_EndWindow(void){
+    uint8 intState = CyEnterCriticalSection();
+    uint32 now = LpTimer_Now();
+    uint32 low = lowTicks;
+    if(inLow != 0u){ // Pulse still running, count it up to now
+        low += now - lowStart;
+        lowStart = now;
+    }
+    lowTicks = 0u;
+    CyExitCriticalSection(intState);
+    
+    uint32 window = now - windowStart;
+    if(window == 0u) return 0u;
+    if(low > window) low = window;
+    return (uint8)((low * 100u) / window); // window < 1311s keeps this in 32 bits
+}
+
+/*******************************************************************
+* NAME :            void PulseCapture_EnableHistogram(uint8 enable)
+*
+* DESCRIPTION :     Switch histogram binning on or off at runtime
+*/
+void PulseCapture_EnableHistogram(uint8 enable){
+    histEnabled = (enable != 0u) ? 1u : 0u;
+}
+
+uint8 PulseCapture_HistogramEnabled(void){
+    return histEnabled;
+}
+
+/*******************************************************************
+* NAME :            uint16 PulseCapture_ReadHistogram(uint8 packed[])
+*
+* DESCRIPTION :     Read and clear the histogram. Bins are scaled so
+*                   the largest one reads 63 and packed 6 bits each,
+*                   bin 0 in the top bits of packed[0].
+* INPUTS :
+*       uint8 packed[PULSECAPTURE_HIST_PACKED_SIZE] Destination
+* OUTPUTS :
+*       uint16 Number of pulses binned since the previous read
+*/
+uint16 PulseCapture_ReadHistogram(uint8 packed[]){
+    uint16 snap[PULSECAPTURE_HIST_BINS];
+    uint16 pulses;
+    uint16 maxBin = 0u;
+    uint32 bits = 0u;
+    uint8 nbits = 0u;
+    uint8 i, out = 0u;
+    
+    uint8 intState = CyEnterCriticalSection();
+    for(i = 0u; i < PULSECAPTURE_HIST_BINS; i++){
+        snap[i] = hist[i];
+        hist[i] = 0u;
+    }
+    pulses = histPulses;
+    histPulses = 0u;
+    CyExitCriticalSection(intState);
+    
+    for(i = 0u; i < PULSECAPTURE_HIST_BINS; i++){
+        if(snap[i] > maxBin) maxBin = snap[i];
+    }
+    for(i = 0u; i < PULSECAPTURE_HIST_BINS; i++){
+        uint32 scaled = (maxBin == 0u) ? 0u : (((uint32)snap[i] * 63u) + maxBin - 1u) / maxBin; // Round up, non-empty bins stay visible
+        bits = (bits << 6) | scaled;
+        nbits += 6u;
+        while(nbits >= 8u){
+            nbits -= 8u;
+            packed[out++] = (uint8)(bits >> nbits);
+        }
+    }
+    return pulses;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,38 @@
+/* ========================================
+ * Air Quality Beacon, part of the hackAIR project.
+ * Freely available under CC BY 4.0
+ *
+ * PPD42 low pulse capture. Both edges of PWM_IN interrupt the CPU,
+ * each low pulse is timestamped on the LF timer and added to the
+ * low pulse occupancy (LPO) total. Optionally every pulse width is
+ * also binned into a log2 histogram for sensor diagnostics.
+ *
+ * http://www.hackair.eu/
+*/
+#ifndef PULSECAPTURE_H
+#define PULSECAPTURE_H
+
+#include <project.h>
+
+/* PWM_IN sits on a GPIO port whose interrupt line equals the port number */
+#define PULSECAPTURE_IRQ                ((uint8)PWM_IN__PORT)
+#define PULSECAPTURE_IRQ_PRIORITY       (3u)
+
+/* Histogram: bin 0 holds pulses shorter than 2*2^BASE_SHIFT LF ticks
+ * (~3.9ms), every following bin doubles the width, the last bin
+ * collects everything from ~250ms up. */
+#define PULSECAPTURE_HIST_BINS          (8u)
+#define PULSECAPTURE_HIST_BASE_SHIFT    (6u)
+#define PULSECAPTURE_HIST_PACKED_SIZE   (6u) // 8 bins x 6 bits
+
+void PulseCapture_Start(void);
+void PulseCapture_BeginWindow(void);
+uint8 PulseCapture_EndWindow(void);
+
+void PulseCapture_EnableHistogram(uint8 enable);
+uint8 PulseCapture_HistogramEnabled(void);
+uint16 PulseCapture_ReadHistogram(uint8 packed[]);
+
+#endif /* PULSECAPTURE_H */
+
+/* [] END OF FILE */
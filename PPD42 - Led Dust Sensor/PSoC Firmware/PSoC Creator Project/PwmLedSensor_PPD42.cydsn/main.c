@@ -12,35 +12,168 @@
 */
 #include <project.h>
 #include <math.h>
+#include "LpTimer.h"
+#include "Scheduler.h"
+#include "PowerMgr.h"
+#include "Energy.h"
+#include "LedPattern.h"
+#include "AdvPolicy.h"
+#include "Beacon.h"
+#include "Cadence.h"
+#include "Supervisor.h"
+#include "ClockMgr.h"
+#include "Dormant.h"
+#include "AdvFrame.h"
+#include "History.h"
+#include "AdvConfig.h"
+#include "AdvPages.h"
+#include "Eddystone.h"
+#include "TxPower.h"
+#include "HistoryService.h"
+#include "LiveStream.h"
+#include "Settings.h"
+#include "ConfigService.h"
+#include "PulseCapture.h"
+
+#define SLOW_WINDOW_MS      SETTINGS_SLOW_DEFAULT_MS    // LPO window in stable air, one measurement per window
+#define BURST_WINDOW_MS     2000u   // LPO window during a burst
+#define WARMUP_MS           60000u  // Sensor settling time after power up
+#define STATS_PERIOD_MS     60000u  // Duty cycle reporting interval
+#define LONG_INTERVAL_MS    900000u // Report period in long interval mode
+#define DORMANT_BURST_MS    3000u   // Advertising window after a long interval report
+
 /* Function prototypes */  
 void StackEventHandler(uint32 event, void* eventParam);
 int16 readParticles();
+void publishHistogram();
+void publishEnergy();
+void publishSupervisor();
+void publishBeacon();
+void publishEddystone();
+void sampleTask();
+void payloadTask();
+void pageTask();
+void warmupTask();
+void statsTask();
+void dormantTask();
+void setSamplePeriod();
+void applySettings();
 
 /* ADV payload dta structure */  
 extern CYBLE_GAPP_DISC_MODE_INFO_T cyBle_discoveryModeInfo;
 #define advPayload   (cyBle_discoveryModeInfo.advData->advData) 
+#define scanPayload  (cyBle_discoveryModeInfo.scanRspData->scanRspData)
+
+/* Estimated current per power state in uA, typical datasheet figures */
+static const uint32 energyTable[ENERGY_STATES] = {
+    6500u,      // CPU active, IMO 48MHz
+    2300u,      // CPU sleep
+    2u,         // CPU and BLESS deep sleep, WCO running
+    90000u,     // PPD42 heater and LED
+    2000u,      // Status LED
+    0u,         // No ADC/UART, pulses are GPIO interrupts
+    20u         // Advertising, 1s interval average at 0dBm
+};
+
+/* Advertising interval policy, change thresholds in pcs/0.01cf */
+static const ADVPOLICY_CONFIG_T advPolicyDefaults = {
+    ADVPOLICY_DEFAULT_MIN, ADVPOLICY_DEFAULT_MAX, 200u, ADVPOLICY_DEFAULT_REL, ADVPOLICY_DEFAULT_FAST
+};
+
+/* Measurement cadence, thresholds in pcs/0.01cf */
+static const CADENCE_CONFIG_T cadenceDefaults = {
+    SLOW_WINDOW_MS, BURST_WINDOW_MS, 1000u, 300u, 10u
+};
+
+/* Defaults above with the parameters of the unit, see Settings.h */
+static ADVPOLICY_CONFIG_T advPolicy;
+static CADENCE_CONFIG_T cadence;
+
+/* Stage deadlines in ms, a stage running longer resets the device */
+static const uint32 stageDeadlines[SUPERVISOR_STAGES] = {
+    500u,       // BLE processing
+    250u,       // Sensor read, LPO window close
+    100u        // Payload update
+};
 
+/* Advertising pages, share of the advertising events per frame type */
+static const ADVPAGES_CONFIG_T advPages = {{
+    4u,     // Measurement
+    1u,     // Energy
+    1u,     // Supervisor
+    1u,     // Histogram, while enabled
+    0u,     // History, scan response only
+    1u,     // Beacon
+    1u,     // Eddystone-UID, with SETTINGS_FLAG_EDDYSTONE
+    1u      // Eddystone-TLM
+}};
+
+static int16 lastVal;       // Latest sensor measurement
+static uint16 dutyPermille; // CPU active time over the last stats period
+static uint8 health = ADVFRAME_HEALTH_WARMUP; // ADVFRAME_HEALTH_* bits owned by this file
+static uint8 sampleTaskId;
+static uint8 payloadTaskId;
+static uint8 pageTaskId;
+static uint32 pageEvents;   // Beacon_Events() when the page on air went up
+static uint8 pageFresh;     // New measurement, replace the page on air right away
+static uint8 dormantTaskId;
 
 int main()
 {
     CyGlobalIntEnable; /* Enable global interrupts. */
 
     /* Start CYBLE component and register the generic event handler */
+    Settings_Recover(); // Finish a configuration commit cut short by a reset
+    AdvConfig_Update(); // Name and frame position of this unit
     CyBle_Start(StackEventHandler);
+    
+    PulseCapture_Start();
+    PulseCapture_BeginWindow();
+    
+    /* Timed tasks, pulse capture happens in the PWM_IN interrupt */
+    LpTimer_Start();
+    Supervisor_Start(stageDeadlines); // Records the stage of a previous watchdog reset
+    uint32 now = LpTimer_Now();
+    Scheduler_ResetStats(now);
+    Energy_Start(energyTable, now);
+    Energy_SetTickRate(LpTimer_TicksPerSec());
+    Energy_LoadOn(ENERGY_SENSOR, now); // Sensor is powered all the time
+    applySettings();
+    AdvPolicy_Init(&advPolicy);
+    Cadence_Init(&cadence);
+    AdvPages_Init(&advPages, ADVFRAME_SENSOR_PPD42);
+    HistoryService_Init(); // Logging for GATT download, with the peripheral role only
+    LiveStream_Init(2u, 1000u); // Every low pulse width in LF ticks
+    sampleTaskId = Scheduler_Add(sampleTask, now, LpTimer_MsToTicks(Cadence_PeriodMs()), LpTimer_MsToTicks(Cadence_PeriodMs()));
+    payloadTaskId = Scheduler_Add(payloadTask, now, 0, 0);
+    pageTaskId = Scheduler_Add(pageTask, now, 0, 0);
+    Scheduler_Add(statsTask, now, LpTimer_MsToTicks(STATS_PERIOD_MS), LpTimer_MsToTicks(STATS_PERIOD_MS));
+    Scheduler_Add(warmupTask, now, LpTimer_MsToTicks(WARMUP_MS), 0);
+    dormantTaskId = Scheduler_Add(dormantTask, now, 0, 0);
+    Scheduler_Stop(payloadTaskId);
+    Scheduler_Stop(pageTaskId);
+    Scheduler_Stop(dormantTaskId);
+    if(Dormant_Enabled()) Scheduler_SetPeriod(sampleTaskId, 0); // One measurement per wakeup
+    LedPattern_Start();
+    LedPattern_SetBackground(LEDPATTERN_WARMUP); // Until the sensor has settled
+    
     for(;;)
     {
-        STATUS_Write(1);CyDelay(300);STATUS_Write(0);
-        int16 val=readParticles(); //Perform sensor measurement
-        
-        /* Dynamic payload will be continuously updated */
-        advPayload[19] =  0x05; //Sensor ID: 0x05 for PPD42
-        advPayload[25] =  val>>8; //High byte of sensor measurement
-        advPayload[26] =  val&0xFF; //Low byte of sensor measurement
-        CyBle_GapUpdateAdvData(cyBle_discoveryModeInfo.advData, cyBle_discoveryModeInfo.scanRspData); //Update Advertisment Packet
-        
-        CyBle_ProcessEvents(); 
-        
-        CyDelay(500); //Measurement delay 
+        ClockMgr_Set(CLOCKMGR_FAST); // PowerMgr_Idle() may leave it slow, code runs at full speed
+        Supervisor_Kick(); // Check in once per iteration, covers the tasks and the sleep
+        Supervisor_Begin(SUPERVISOR_STAGE_BLE);
+        CyBle_ProcessEvents();
+        Beacon_Commit(); // Advertisment update that waited for a radio event to end
+        HistoryService_Pump(); // Queue history notifications while the stack has room
+        LiveStream_Pump(); // Raw samples of a calibration session
+        if(ConfigService_Pump()){ // Configuration committed over GATT, apply it now
+            applySettings();
+            setSamplePeriod();
+            if(AdvConfig_Update()) Beacon_UpdateData();
+        }
+        Supervisor_End();
+        Scheduler_Dispatch(LpTimer_Now());
+        Scheduler_AddSleep(PowerMgr_Idle(Scheduler_NextDue(LpTimer_Now()), 1u)); // Sleep until next event
     }
 }
 
@@ -51,34 +184,305 @@ void StackEventHandler(uint32 event, void *eventParam)
         
 		case CYBLE_EVT_STACK_ON:
 			/* BLE stack is on. Start BLE advertisement */   
-			CyBle_GappStartAdvertisement(CYBLE_ADVERTISING_FAST);
+			ConfigService_Init();
+			Beacon_StartAdvertising();
+		    break;
+		
+		case CYBLE_EVT_GAPP_ADVERTISEMENT_START_STOP:
+			/* Restart after an advertising interval change */
+			Beacon_AdvStartStop();
+			Dormant_Advertising(LpTimer_Now());
+		    break;
+		
+#if (BEACON_SCAN_REQ_EVENTS)
+		case CYBLE_EVT_GAP_SCAN_REQ_RECVD:
+			/* Someone is actively scanning */
+			Beacon_ScanRequest(LpTimer_Now());
+		    break;
+#endif
+		
+#if (CYBLE_GAP_ROLE_PERIPHERAL)
+		case CYBLE_EVT_GAP_DEVICE_CONNECTED:
+			/* Advertising stopped for the connection */
+			Beacon_Stopped();
+		    break;
+		
+		case CYBLE_EVT_GAP_DEVICE_DISCONNECTED:
+			HistoryService_Disconnected();
+			LiveStream_Disconnected();
+			setSamplePeriod(); // Back to the measurement cadence
+			Beacon_StartAdvertising();
+		    break;
+		
+		case CYBLE_EVT_GATTS_WRITE_REQ:
+			if(!HistoryService_Write((CYBLE_GATTS_WRITE_REQ_PARAM_T *)eventParam) &&
+			   !ConfigService_Write((CYBLE_GATTS_WRITE_REQ_PARAM_T *)eventParam)){
+				(void)LiveStream_Write((CYBLE_GATTS_WRITE_REQ_PARAM_T *)eventParam);
+				setSamplePeriod(); // Stream rate, if one was written
+			}
+		    break;
+		
+		case CYBLE_EVT_STACK_BUSY_STATUS:
+			/* Stack buffers full or free again */
+			LiveStream_StackBusy(*(uint8 *)eventParam);
 		    break;
 		
+		case CYBLE_EVT_GATTS_XCNHG_MTU_REQ:
+			/* Answered by the BLE component, larger notifications from now on */
+			HistoryService_MtuExchanged((CYBLE_GATT_XCHG_MTU_PARAM_T *)eventParam);
+		    break;
+#endif
+		
         default:
             break;
     }   	
 
 }
 
+/*******************************************************************
+* NAME :            void sampleTask()
+*
+* DESCRIPTION :     Periodic task: blink and close the measurement
+*                   window
+*/
+void sampleTask(){
+    LedPattern_Play(LEDPATTERN_MEASURING); //Status blink, plays while we sleep
+    
+    Supervisor_Begin(SUPERVISOR_STAGE_SENSOR);
+    lastVal=readParticles(); //Perform sensor measurement
+    Supervisor_End();
+    Scheduler_Trigger(payloadTaskId, LpTimer_Now(), 0);
+}
+
+/*******************************************************************
+* NAME :            void payloadTask()
+*
+* DESCRIPTION :     Refresh the advertising pages and the history
+*                   with the latest measurement
+*/
+void payloadTask(){
+    ClockMgr_Set(CLOCKMGR_FAST); // BLE API calls
+    Supervisor_Begin(SUPERVISOR_STAGE_PAYLOAD);
+    History_Add(lastVal, LpTimer_Now());
+    HistoryService_Add(lastVal, LpTimer_Now());
+    AdvPolicy_ScanQuiet(Beacon_ScanQuietSecs(LpTimer_Now())); //Stay fast while someone scans
+    Beacon_SetInterval(AdvPolicy_Update(lastVal)); //Advertise faster while the value changes
+    if(Dormant_Enabled()) Scheduler_Trigger(dormantTaskId, LpTimer_Now(), LpTimer_MsToTicks(DORMANT_BURST_MS)); //Advertise for a while, then shut down
+    else Scheduler_ChangePeriod(sampleTaskId, LpTimer_Now(), LpTimer_MsToTicks(LiveStream_PeriodMs(Cadence_Update(lastVal)))); //Burst on spikes, slow down in clean air
+    Beacon_SetTxPower(TxPower_Level(TXPOWER_CONFIG, Cadence_InBurst())); //Reach further during a burst, if configured
+    
+    /* Pages are refreshed per measurement, pageTask rotates them */
+    AdvFrame_PutMeasurement(AdvPages_Edit(ADVFRAME_TYPE_MEASUREMENT)->body, ADVFRAME_NA, ADVFRAME_NA, ADVFRAME_NA, lastVal, ADVFRAME_BATTERY_NA); //Concentration in pcs/0.01cf
+    publishEnergy();
+    publishSupervisor();
+    publishBeacon();
+    publishEddystone();
+    publishHistogram();
+    cyBle_discoveryModeInfo.scanRspData->scanRspDataLen = History_Write(scanPayload, ADVFRAME_SENSOR_PPD42, LpTimer_Now()); //Readings a scanner may have missed
+    AdvPages_Restart(); //New measurement goes out first
+    pageFresh = 1; //Replace the page on air even if it has not gone out
+    Scheduler_Trigger(pageTaskId, LpTimer_Now(), 0);
+    Supervisor_End();
+}
+
+/*******************************************************************
+* NAME :            void pageTask()
+*
+* DESCRIPTION :     Runs just after each advertising event, at the
+*                   interval in force: put the next page in the
+*                   advertisement, bring the history age in the scan
+*                   response up to now. A page stays until it went
+*                   out, unless a new measurement replaces it.
+*/
+void pageTask(){
+    uint32 now = LpTimer_Now();
+    uint32 events = Beacon_Events(now);
+    uint32 wait = Beacon_TicksPastEvent(now);
+    ADVFRAME_T *page;
+    
+    Scheduler_Trigger(pageTaskId, now, (wait != 0u) ? wait : LpTimer_MsToTicks(Beacon_IntervalMs())); //After the next advertising event, or one interval on while not advertising
+    if((events == pageEvents) && !pageFresh) return; // Page on air hasn't gone out yet
+    page = AdvPages_Next(Cadence_InBurst() && !Dormant_Enabled()); //Burst readings go out unmixed
+    if(page == 0) return; // Nothing measured yet
+    pageEvents = events;
+    pageFresh = 0;
+    ClockMgr_Set(CLOCKMGR_FAST); // BLE API calls
+    Supervisor_Begin(SUPERVISOR_STAGE_PAYLOAD);
+    if(page->type >= EDDYSTONE_PAGE_UID){
+        cyBle_discoveryModeInfo.advData->advDataLen = Eddystone_Write(page->type, advPayload);
+    }else{
+        AdvConfig_Restore(); //Name in front of the frame again after an Eddystone page
+        page->health = health | ((Supervisor_LastFault() != SUPERVISOR_STAGE_NONE) ? ADVFRAME_HEALTH_WDT_RESET : 0u);
+        page->flags = Dormant_Enabled() ? ADVFRAME_FLAG_LONG_INTERVAL : (Cadence_InBurst() ? ADVFRAME_FLAG_BURST : 0u);
+        cyBle_discoveryModeInfo.advData->advDataLen = AdvFrame_Encode(page, advPayload);
+    }
+    cyBle_discoveryModeInfo.scanRspData->scanRspDataLen = History_Write(scanPayload, ADVFRAME_SENSOR_PPD42, LpTimer_Now()); //Age of the newest reading
+    Beacon_UpdateData(); //Update Advertisment Packet if it changed
+    Supervisor_End();
+}
+
+/*******************************************************************
+* NAME :            void warmupTask()
+*
+* DESCRIPTION :     One shot task: sensor has settled, stop the
+*                   warm-up pattern
+*/
+void warmupTask(){
+    LedPattern_SetBackground(LEDPATTERN_OFF);
+    health &= ~ADVFRAME_HEALTH_WARMUP;
+}
+
+/*******************************************************************
+* NAME :            void statsTask()
+*
+* DESCRIPTION :     Periodic task: sample the CPU duty cycle and
+*                   start new energy and stage latency windows,
+*                   recalibrate the LF clock, pick up a rewritten
+*                   unit configuration
+*/
+void statsTask(){
+    uint32 now = LpTimer_Now();
+    dutyPermille = Scheduler_DutyPermille(now);
+    Scheduler_ResetStats(now);
+    Energy_ResetWindow(now);
+    Supervisor_ResetStats();
+    Beacon_ResetWindow();
+    LpTimer_Calibrate(); // ILO drifts with temperature, does nothing with the WCO
+    Energy_SetTickRate(LpTimer_TicksPerSec());
+    if(AdvConfig_Update()) Beacon_UpdateData();
+}
+
+/*******************************************************************
+* NAME :            void dormantTask()
+*
+* DESCRIPTION :     Long interval mode: shut down until the next
+*                   report is due, then measure straight away
+*/
+void dormantTask(){
+    uint32 now = LpTimer_Now();
+    if(CyBle_GetState() == CYBLE_STATE_CONNECTED){ // Let a download finish
+        Scheduler_Trigger(dormantTaskId, now, LpTimer_MsToTicks(DORMANT_BURST_MS));
+        return;
+    }
+    Scheduler_Stop(pageTaskId); // Nothing on air until the next report
+    Scheduler_AddSleep(Dormant_Enter(now + LpTimer_MsToTicks(LONG_INTERVAL_MS - DORMANT_BURST_MS)));
+    Scheduler_Trigger(sampleTaskId, LpTimer_Now(), 0);
+}
+
+/*******************************************************************
+* NAME :            void setSamplePeriod()
+*
+* DESCRIPTION :     Sample at the rate of a live stream client, or
+*                   at the measurement cadence without one
+*/
+void setSamplePeriod(){
+    uint32 ms = LiveStream_PeriodMs(Dormant_Enabled() ? 0u : Cadence_PeriodMs());
+    Scheduler_ChangePeriod(sampleTaskId, LpTimer_Now(), LpTimer_MsToTicks(ms));
+}
+
+/*******************************************************************
+* NAME :            void applySettings()
+*
+* DESCRIPTION :     Take the parameters of the unit on top of the
+*                   defaults of this firmware, at boot and after a
+*                   commit over GATT
+*/
+void applySettings(){
+    Settings_Cadence(&cadenceDefaults, &cadence);
+    Settings_AdvPolicy(&advPolicyDefaults, &advPolicy);
+    PulseCapture_EnableHistogram(SETTINGS_FLAGS & SETTINGS_FLAG_HISTOGRAM);
+}
+
 /*******************************************************************
 * NAME :            int16 readParticles()
 *
-* DESCRIPTION :     Read sensor measurement
+* DESCRIPTION :     Read sensor measurement. Windows are back to
+*                   back, the next one starts right away.
 * OUTPUTS :
 *       int16 Dust concentration in pcs/0.01cf
 */
 int16 readParticles(){
-    int i; 
-    int dur=0;
-    
-    for(i=0;i<2000000;i++){
-      CyDelayUs(1);
-      dur+=!PWM_IN_Read();//Count low pulse Duration
-    }
-    int ratio = dur/20000;
+    int ratio = PulseCapture_EndWindow(); // Low pulse occupancy in %
+    PulseCapture_BeginWindow();
     uint16 senDat = (uint16)(1.1 * pow(ratio, 3.0) - 3.8 * pow(ratio, 2.0) + 520 * ratio + 0.62); // Sensor transfer function
     
     return senDat;
 }
 
+/*******************************************************************
+* NAME :            void publishHistogram()
+*
+* DESCRIPTION :     Histogram page: pulse count (saturated) and
+*                   the 8 packed 6-bit pulse width bins, out of the
+*                   rotation while the histogram is disabled
+*/
+void publishHistogram(){
+    ADVFRAME_T *page;
+    uint16 pulses;
+    
+    if(!PulseCapture_HistogramEnabled()){
+        AdvPages_Drop(ADVFRAME_TYPE_HISTOGRAM);
+        return;
+    }
+    page = AdvPages_Edit(ADVFRAME_TYPE_HISTOGRAM);
+    pulses = PulseCapture_ReadHistogram(&page->body[1]);
+    page->body[0] = (pulses > 0xFF) ? 0xFF : pulses; //Pulses in histogram
+    page->body[7] = 0;
+}
+
+/*******************************************************************
+* NAME :            void publishEnergy()
+*
+* DESCRIPTION :     Energy page: Energy_WriteFrame() layout and
+*                   the CPU duty cycle in 0.1% steps
+*/
+void publishEnergy(){
+    ADVFRAME_T *page = AdvPages_Edit(ADVFRAME_TYPE_ENERGY);
+    Energy_WriteFrame(page->body, LpTimer_Now());
+    page->body[ENERGY_FRAME_LEN] = (dutyPermille > 0xFF) ? 0xFF : dutyPermille;
+}
+
+/*******************************************************************
+* NAME :            void publishSupervisor()
+*
+* DESCRIPTION :     Supervisor page: stage latencies, the last
+*                   watchdog fault and the wake to advertise latency
+*                   of long interval mode in 10ms steps
+*/
+void publishSupervisor(){
+    ADVFRAME_T *page = AdvPages_Edit(ADVFRAME_TYPE_SUPERVISOR);
+    Supervisor_WriteFrame(page->body);
+    page->body[SUPERVISOR_FRAME_LEN] = Dormant_LatencyFrame();
+}
+
+/*******************************************************************
+* NAME :            void publishBeacon()
+*
+* DESCRIPTION :     Beacon page: committed, skipped and deferred
+*                   advertising data updates, TX power, scan
+*                   requests
+*/
+void publishBeacon(){
+    ADVFRAME_T *page = AdvPages_Edit(ADVFRAME_TYPE_BEACON);
+    Beacon_WriteFrame(page->body);
+}
+
+/*******************************************************************
+* NAME :            void publishEddystone()
+*
+* DESCRIPTION :     Eddystone-UID and Eddystone-TLM pages, encoded
+*                   here once per measurement, out of the rotation
+*                   while SETTINGS_FLAG_EDDYSTONE is clear
+*/
+void publishEddystone(){
+    if(!Eddystone_Enabled()){
+        AdvPages_Drop(EDDYSTONE_PAGE_UID);
+        AdvPages_Drop(EDDYSTONE_PAGE_TLM);
+        return;
+    }
+    Eddystone_Update(LpTimer_Now());
+    AdvPages_Edit(EDDYSTONE_PAGE_UID);
+    AdvPages_Edit(EDDYSTONE_PAGE_TLM);
+}
+
 /* [] END OF FILE */
@@ -11,38 +11,185 @@
  * http://www.hackair.eu/
 */
 #include <project.h>
+#include "LpTimer.h"
+#include "Scheduler.h"
+#include "PowerMgr.h"
+#include "Energy.h"
+#include "LedPattern.h"
+#include "AdvPolicy.h"
+#include "Beacon.h"
+#include "Cadence.h"
+#include "Supervisor.h"
+#include "ClockMgr.h"
+#include "Dormant.h"
+#include "AdvFrame.h"
+#include "History.h"
+#include "AdvConfig.h"
+#include "AdvPages.h"
+#include "Eddystone.h"
+#include "TxPower.h"
+#include "HistoryService.h"
+#include "LiveStream.h"
+#include "Settings.h"
+#include "ConfigService.h"
+
+#define SLOW_PERIOD_MS          SETTINGS_SLOW_DEFAULT_MS    // Sampling interval in stable air
+#define BURST_PERIOD_MS         1000u   // Sampling interval during a burst
+#define LISTEN_TIMEOUT_MS       2500u   // Give up on a packet after this long
+#define STATS_PERIOD_MS         60000u  // Duty cycle reporting interval
+#define LONG_INTERVAL_MS        900000u // Report period in long interval mode
+#define DORMANT_BURST_MS        3000u   // Advertising window after a long interval report
+#define PACKET_LEN              32u     // Sensor TX packet length
+#define PACKET_HEAD             0x42    // Sensor TX packet start character
+#define PACKET_HEAD2            0x4D    // Sensor TX packet second start character
 
 /* Function prototypes */  
 void StackEventHandler(uint32 event, void* eventParam);
-char* readParticles();
+uint8 pollParticles();
+uint8 packetValid();
+void sampleTask();
+void payloadTask();
+void pageTask();
+void timeoutTask();
+void publishEnergy();
+void publishSupervisor();
+void publishBeacon();
+void publishEddystone();
+void statsTask();
+void dormantTask();
+void setSamplePeriod();
+void applySettings();
 
 /* ADV payload dta structure */  
 extern CYBLE_GAPP_DISC_MODE_INFO_T cyBle_discoveryModeInfo;
 #define advPayload   (cyBle_discoveryModeInfo.advData->advData) 
+#define scanPayload  (cyBle_discoveryModeInfo.scanRspData->scanRspData)
+
+/* Estimated current per power state in uA, typical datasheet figures */
+static const uint32 energyTable[ENERGY_STATES] = {
+    6500u,      // CPU active, IMO 48MHz
+    2300u,      // CPU sleep
+    2u,         // CPU and BLESS deep sleep, WCO running
+    100000u,    // SEN0177 fan and laser
+    2000u,      // Status LED
+    300u,       // SCB UART
+    20u         // Advertising, 1s interval average at 0dBm
+};
+
+/* Advertising interval policy, change thresholds in ug/m^3 */
+static const ADVPOLICY_CONFIG_T advPolicyDefaults = {
+    ADVPOLICY_DEFAULT_MIN, ADVPOLICY_DEFAULT_MAX, 5u, ADVPOLICY_DEFAULT_REL, ADVPOLICY_DEFAULT_FAST
+};
+
+/* Measurement cadence, thresholds in ug/m^3 PM2.5 */
+static const CADENCE_CONFIG_T cadenceDefaults = {
+    SLOW_PERIOD_MS, BURST_PERIOD_MS, 35u, 10u, 10u
+};
+
+/* Defaults above with the parameters of the unit, see Settings.h */
+static ADVPOLICY_CONFIG_T advPolicy;
+static CADENCE_CONFIG_T cadence;
+
+/* Stage deadlines in ms, a stage running longer resets the device */
+static const uint32 stageDeadlines[SUPERVISOR_STAGES] = {
+    500u,       // BLE processing
+    250u,       // Sensor read, UART buffer drain
+    100u        // Payload update
+};
 
+/* Advertising pages, share of the advertising events per frame type */
+static const ADVPAGES_CONFIG_T advPages = {{
+    4u,     // Measurement
+    1u,     // Energy
+    1u,     // Supervisor
+    0u,     // Histogram, PPD42 only
+    0u,     // History, scan response only
+    1u,     // Beacon
+    1u,     // Eddystone-UID, with SETTINGS_FLAG_EDDYSTONE
+    1u      // Eddystone-TLM
+}};
+
+static char senData[PACKET_LEN]; // Latest sensor TX packet
+static uint8 rxIdx;         // Bytes of the packet received so far
+static uint8 listening;     // UART needs the HFCLK, no deep sleep while set
+static uint16 dutyPermille; // CPU active time over the last stats period
+static uint8 health = ADVFRAME_HEALTH_WARMUP; // ADVFRAME_HEALTH_* bits owned by this file
+static uint8 sampleTaskId;
+static uint8 payloadTaskId;
+static uint8 pageTaskId;
+static uint32 pageEvents;   // Beacon_Events() when the page on air went up
+static uint8 pageFresh;     // New measurement, replace the page on air right away
+static uint8 dormantTaskId;
+static uint8 timeoutTaskId;
 
 int main()
 {
     CyGlobalIntEnable; /* Enable global interrupts. */
     Serial_Start();
     /* Start CYBLE component and register the generic event handler */
+    Settings_Recover(); // Finish a configuration commit cut short by a reset
+    AdvConfig_Update(); // Name and frame position of this unit
     CyBle_Start(StackEventHandler);
     
+    /* Timed tasks, packets are collected from the UART buffer in the loop */
+    LpTimer_Start();
+    Supervisor_Start(stageDeadlines); // Records the stage of a previous watchdog reset
+    uint32 now = LpTimer_Now();
+    Scheduler_ResetStats(now);
+    Energy_Start(energyTable, now);
+    Energy_SetTickRate(LpTimer_TicksPerSec());
+    Energy_LoadOn(ENERGY_SENSOR, now); // Sensor is powered all the time
+    applySettings();
+    AdvPolicy_Init(&advPolicy);
+    Cadence_Init(&cadence);
+    AdvPages_Init(&advPages, ADVFRAME_SENSOR_SEN0177);
+    HistoryService_Init(); // Logging for GATT download, with the peripheral role only
+    LiveStream_Init(PACKET_LEN, 1000u); // Every sensor packet, the sensor sends one per second
+    sampleTaskId = Scheduler_Add(sampleTask, now, 0, LpTimer_MsToTicks(Cadence_PeriodMs()));
+    payloadTaskId = Scheduler_Add(payloadTask, now, 0, 0);
+    pageTaskId = Scheduler_Add(pageTask, now, 0, 0);
+    timeoutTaskId = Scheduler_Add(timeoutTask, now, 0, 0);
+    Scheduler_Add(statsTask, now, LpTimer_MsToTicks(STATS_PERIOD_MS), LpTimer_MsToTicks(STATS_PERIOD_MS));
+    dormantTaskId = Scheduler_Add(dormantTask, now, 0, 0);
+    Scheduler_Stop(payloadTaskId);
+    Scheduler_Stop(pageTaskId);
+    Scheduler_Stop(dormantTaskId);
+    if(Dormant_Enabled()) Scheduler_SetPeriod(sampleTaskId, 0); // One measurement per wakeup
+    Scheduler_Stop(timeoutTaskId);
+    LedPattern_Start();
+    LedPattern_SetBackground(LEDPATTERN_WARMUP); // Until the sensor has settled
+    
     for(;;)
     {
-        STATUS_Write(1);CyDelay(300);STATUS_Write(0);
-        char *val=readParticles(); //Perform sensor measurement (waits for result)
-         
-        /* Dynamic payload will be continuously updated */
-        advPayload[19] =  0x01; //Sensor ID: 0x01 for SEN0177
-        advPayload[21] =  val[4]; //High byte of PM1 value
-        advPayload[22] =  val[5]; //Low byte of PM1 value
-        advPayload[23] =  val[6]; //High byte of PM2.5 value
-        advPayload[24] =  val[7]; //Low byte of PM2.5 value
-        advPayload[25] =  val[8]; //High byte of PM10 value
-        advPayload[26] =  val[9]; //Low byte of PM10 value
-        CyBle_GapUpdateAdvData(cyBle_discoveryModeInfo.advData, cyBle_discoveryModeInfo.scanRspData); //Update Advertisment Packet
+        ClockMgr_Set(CLOCKMGR_FAST); // PowerMgr_Idle() may leave it slow, code runs at full speed
+        Supervisor_Kick(); // Check in once per iteration, covers the tasks and the sleep
+        Supervisor_Begin(SUPERVISOR_STAGE_BLE);
         CyBle_ProcessEvents();
+        Beacon_Commit(); // Advertisment update that waited for a radio event to end
+        HistoryService_Pump(); // Queue history notifications while the stack has room
+        LiveStream_Pump(); // Raw samples of a calibration session
+        if(ConfigService_Pump()){ // Configuration committed over GATT, apply it now
+            applySettings();
+            setSamplePeriod();
+            if(AdvConfig_Update()) Beacon_UpdateData();
+        }
+        Supervisor_End();
+        if(listening){
+            Supervisor_Begin(SUPERVISOR_STAGE_SENSOR);
+            uint8 complete = pollParticles();
+            Supervisor_End();
+            if(complete){ // Complete packet received
+                listening=0;
+                Energy_LoadOff(ENERGY_PERIPH, LpTimer_Now());
+                Scheduler_Stop(timeoutTaskId);
+                LedPattern_SetBackground(LEDPATTERN_OFF); // Sensor is answering
+                health = 0;
+                LiveStream_Put((const uint8 *)senData); // Raw packet, while streaming
+                Scheduler_Trigger(payloadTaskId, LpTimer_Now(), 0);
+            }
+        }
+        Scheduler_Dispatch(LpTimer_Now());
+        Scheduler_AddSleep(PowerMgr_Idle(Scheduler_NextDue(LpTimer_Now()), !listening)); // Sleep until next event, RX interrupt wakes us while listening
     }
 }
 
@@ -53,8 +200,54 @@ void StackEventHandler(uint32 event, void *eventParam)
         
 		case CYBLE_EVT_STACK_ON:
 			/* BLE stack is on. Start BLE advertisement */   
-			CyBle_GappStartAdvertisement(CYBLE_ADVERTISING_FAST);
+			ConfigService_Init();
+			Beacon_StartAdvertising();
+		    break;
+		
+		case CYBLE_EVT_GAPP_ADVERTISEMENT_START_STOP:
+			/* Restart after an advertising interval change */
+			Beacon_AdvStartStop();
+			Dormant_Advertising(LpTimer_Now());
+		    break;
+		
+#if (BEACON_SCAN_REQ_EVENTS)
+		case CYBLE_EVT_GAP_SCAN_REQ_RECVD:
+			/* Someone is actively scanning */
+			Beacon_ScanRequest(LpTimer_Now());
 		    break;
+#endif
+		
+#if (CYBLE_GAP_ROLE_PERIPHERAL)
+		case CYBLE_EVT_GAP_DEVICE_CONNECTED:
+			/* Advertising stopped for the connection */
+			Beacon_Stopped();
+		    break;
+		
+		case CYBLE_EVT_GAP_DEVICE_DISCONNECTED:
+			HistoryService_Disconnected();
+			LiveStream_Disconnected();
+			setSamplePeriod(); // Back to the measurement cadence
+			Beacon_StartAdvertising();
+		    break;
+		
+		case CYBLE_EVT_GATTS_WRITE_REQ:
+			if(!HistoryService_Write((CYBLE_GATTS_WRITE_REQ_PARAM_T *)eventParam) &&
+			   !ConfigService_Write((CYBLE_GATTS_WRITE_REQ_PARAM_T *)eventParam)){
+				(void)LiveStream_Write((CYBLE_GATTS_WRITE_REQ_PARAM_T *)eventParam);
+				setSamplePeriod(); // Stream rate, if one was written
+			}
+		    break;
+		
+		case CYBLE_EVT_STACK_BUSY_STATUS:
+			/* Stack buffers full or free again */
+			LiveStream_StackBusy(*(uint8 *)eventParam);
+		    break;
+		
+		case CYBLE_EVT_GATTS_XCNHG_MTU_REQ:
+			/* Answered by the BLE component, larger notifications from now on */
+			HistoryService_MtuExchanged((CYBLE_GATT_XCHG_MTU_PARAM_T *)eventParam);
+		    break;
+#endif
 		
         default:
             break;
@@ -63,22 +256,263 @@ void StackEventHandler(uint32 event, void *eventParam)
 }
 
 /*******************************************************************
-* NAME :            char* readParticles()
+* NAME :            void sampleTask()
+*
+* DESCRIPTION :     Periodic task: blink and start listening for
+*                   the next sensor packet
+*/
+void sampleTask(){
+    if(listening) return; // Previous packet still pending
+    
+    LedPattern_Play(LEDPATTERN_MEASURING); //Status blink, plays while we sleep
+    
+    Serial_SpiUartClearRxBuffer(); // Drop stale bytes, start on a fresh packet
+    rxIdx=0;
+    listening=1;
+    Energy_LoadOn(ENERGY_PERIPH, LpTimer_Now());
+    Scheduler_Trigger(timeoutTaskId, LpTimer_Now(), LpTimer_MsToTicks(LISTEN_TIMEOUT_MS));
+}
+
+/*******************************************************************
+* NAME :            void payloadTask()
+*
+* DESCRIPTION :     Refresh the advertising pages and the history
+*                   with the latest measurement
+*/
+void payloadTask(){
+    ClockMgr_Set(CLOCKMGR_FAST); // BLE API calls
+    Supervisor_Begin(SUPERVISOR_STAGE_PAYLOAD);
+    uint16 pm25= (uint8)senData[6]*256 + (uint8)senData[7]; //PM2.5 value
+    int16 histVal= (pm25 > HISTORY_VALUE_MAX) ? HISTORY_VALUE_MAX : (int16)pm25; //History holds signed readings
+    History_Add(histVal, LpTimer_Now());
+    HistoryService_Add(histVal, LpTimer_Now());
+    AdvPolicy_ScanQuiet(Beacon_ScanQuietSecs(LpTimer_Now())); //Stay fast while someone scans
+    Beacon_SetInterval(AdvPolicy_Update(pm25)); //Advertise faster while PM2.5 changes
+    if(Dormant_Enabled()) Scheduler_Trigger(dormantTaskId, LpTimer_Now(), LpTimer_MsToTicks(DORMANT_BURST_MS)); //Advertise for a while, then shut down
+    else Scheduler_ChangePeriod(sampleTaskId, LpTimer_Now(), LpTimer_MsToTicks(LiveStream_PeriodMs(Cadence_Update(pm25)))); //Burst on spikes, slow down in clean air
+    Beacon_SetTxPower(TxPower_Level(TXPOWER_CONFIG, Cadence_InBurst())); //Reach further during a burst, if configured
+    
+    /* Pages are refreshed per measurement, pageTask rotates them */
+    AdvFrame_PutMeasurement(AdvPages_Edit(ADVFRAME_TYPE_MEASUREMENT)->body, ((uint8)senData[4]*256 + (uint8)senData[5])*10, //ug/m^3 to 0.1ug/m^3
+        pm25*10, ((uint8)senData[8]*256 + (uint8)senData[9])*10, ADVFRAME_NA, ADVFRAME_BATTERY_NA);
+    publishEnergy();
+    publishSupervisor();
+    publishBeacon();
+    publishEddystone();
+    cyBle_discoveryModeInfo.scanRspData->scanRspDataLen = History_Write(scanPayload, ADVFRAME_SENSOR_SEN0177, LpTimer_Now()); //Readings a scanner may have missed
+    AdvPages_Restart(); //New measurement goes out first
+    pageFresh = 1; //Replace the page on air even if it has not gone out
+    Scheduler_Trigger(pageTaskId, LpTimer_Now(), 0);
+    Supervisor_End();
+}
+
+/*******************************************************************
+* NAME :            void pageTask()
+*
+* DESCRIPTION :     Runs just after each advertising event, at the
+*                   interval in force: put the next page in the
+*                   advertisement, bring the history age in the scan
+*                   response up to now. A page stays until it went
+*                   out, unless a new measurement replaces it.
+*/
+void pageTask(){
+    uint32 now = LpTimer_Now();
+    uint32 events = Beacon_Events(now);
+    uint32 wait = Beacon_TicksPastEvent(now);
+    ADVFRAME_T *page;
+    
+    Scheduler_Trigger(pageTaskId, now, (wait != 0u) ? wait : LpTimer_MsToTicks(Beacon_IntervalMs())); //After the next advertising event, or one interval on while not advertising
+    if((events == pageEvents) && !pageFresh) return; // Page on air hasn't gone out yet
+    page = AdvPages_Next(Cadence_InBurst() && !Dormant_Enabled()); //Burst readings go out unmixed
+    if(page == 0) return; // Nothing measured yet
+    pageEvents = events;
+    pageFresh = 0;
+    ClockMgr_Set(CLOCKMGR_FAST); // BLE API calls
+    Supervisor_Begin(SUPERVISOR_STAGE_PAYLOAD);
+    if(page->type >= EDDYSTONE_PAGE_UID){
+        cyBle_discoveryModeInfo.advData->advDataLen = Eddystone_Write(page->type, advPayload);
+    }else{
+        AdvConfig_Restore(); //Name in front of the frame again after an Eddystone page
+        page->health = health | ((Supervisor_LastFault() != SUPERVISOR_STAGE_NONE) ? ADVFRAME_HEALTH_WDT_RESET : 0u);
+        page->flags = Dormant_Enabled() ? ADVFRAME_FLAG_LONG_INTERVAL : (Cadence_InBurst() ? ADVFRAME_FLAG_BURST : 0u);
+        cyBle_discoveryModeInfo.advData->advDataLen = AdvFrame_Encode(page, advPayload);
+    }
+    cyBle_discoveryModeInfo.scanRspData->scanRspDataLen = History_Write(scanPayload, ADVFRAME_SENSOR_SEN0177, LpTimer_Now()); //Age of the newest reading
+    Beacon_UpdateData(); //Update Advertisment Packet if it changed
+    Supervisor_End();
+}
+
+/*******************************************************************
+* NAME :            void timeoutTask()
+*
+* DESCRIPTION :     No packet in time, keep the last payload,
+*                   signal the error and allow deep sleep again
+*/
+void timeoutTask(){
+    listening=0;
+    Energy_LoadOff(ENERGY_PERIPH, LpTimer_Now());
+    LedPattern_SetBackground(LEDPATTERN_ERROR);
+    health |= ADVFRAME_HEALTH_SENSOR_FAULT;
+    if(Dormant_Enabled()) Scheduler_Trigger(dormantTaskId, LpTimer_Now(), 0); //Try again on the next wakeup
+}
+
+/*******************************************************************
+* NAME :            void publishEnergy()
+*
+* DESCRIPTION :     Energy page: Energy_WriteFrame() layout and
+*                   the CPU duty cycle in 0.1% steps
+*/
+void publishEnergy(){
+    ADVFRAME_T *page = AdvPages_Edit(ADVFRAME_TYPE_ENERGY);
+    Energy_WriteFrame(page->body, LpTimer_Now());
+    page->body[ENERGY_FRAME_LEN] = (dutyPermille > 0xFF) ? 0xFF : dutyPermille;
+}
+
+/*******************************************************************
+* NAME :            void publishSupervisor()
+*
+* DESCRIPTION :     Supervisor page: stage latencies, the last
+*                   watchdog fault and the wake to advertise latency
+*                   of long interval mode in 10ms steps
+*/
+void publishSupervisor(){
+    ADVFRAME_T *page = AdvPages_Edit(ADVFRAME_TYPE_SUPERVISOR);
+    Supervisor_WriteFrame(page->body);
+    page->body[SUPERVISOR_FRAME_LEN] = Dormant_LatencyFrame();
+}
+
+/*******************************************************************
+* NAME :            void publishBeacon()
+*
+* DESCRIPTION :     Beacon page: committed, skipped and deferred
+*                   advertising data updates, TX power, scan
+*                   requests
+*/
+void publishBeacon(){
+    ADVFRAME_T *page = AdvPages_Edit(ADVFRAME_TYPE_BEACON);
+    Beacon_WriteFrame(page->body);
+}
+
+/*******************************************************************
+* NAME :            void publishEddystone()
+*
+* DESCRIPTION :     Eddystone-UID and Eddystone-TLM pages, encoded
+*                   here once per measurement, out of the rotation
+*                   while SETTINGS_FLAG_EDDYSTONE is clear
+*/
+void publishEddystone(){
+    if(!Eddystone_Enabled()){
+        AdvPages_Drop(EDDYSTONE_PAGE_UID);
+        AdvPages_Drop(EDDYSTONE_PAGE_TLM);
+        return;
+    }
+    Eddystone_Update(LpTimer_Now());
+    AdvPages_Edit(EDDYSTONE_PAGE_UID);
+    AdvPages_Edit(EDDYSTONE_PAGE_TLM);
+}
+
+/*******************************************************************
+* NAME :            void statsTask()
+*
+* DESCRIPTION :     Periodic task: sample the CPU duty cycle and
+*                   start new energy and stage latency windows,
+*                   recalibrate the LF clock, pick up a rewritten
+*                   unit configuration
+*/
+void statsTask(){
+    uint32 now = LpTimer_Now();
+    dutyPermille = Scheduler_DutyPermille(now);
+    Scheduler_ResetStats(now);
+    Energy_ResetWindow(now);
+    Supervisor_ResetStats();
+    Beacon_ResetWindow();
+    LpTimer_Calibrate(); // ILO drifts with temperature, does nothing with the WCO
+    Energy_SetTickRate(LpTimer_TicksPerSec());
+    if(AdvConfig_Update()) Beacon_UpdateData();
+}
+
+/*******************************************************************
+* NAME :            void dormantTask()
+*
+* DESCRIPTION :     Long interval mode: shut down until the next
+*                   report is due, then measure straight away
+*/
+void dormantTask(){
+    uint32 now = LpTimer_Now();
+    if(CyBle_GetState() == CYBLE_STATE_CONNECTED){ // Let a download finish
+        Scheduler_Trigger(dormantTaskId, now, LpTimer_MsToTicks(DORMANT_BURST_MS));
+        return;
+    }
+    Scheduler_Stop(pageTaskId); // Nothing on air until the next report
+    Scheduler_AddSleep(Dormant_Enter(now + LpTimer_MsToTicks(LONG_INTERVAL_MS - DORMANT_BURST_MS)));
+    Scheduler_Trigger(sampleTaskId, LpTimer_Now(), 0);
+}
+
+/*******************************************************************
+* NAME :            void setSamplePeriod()
+*
+* DESCRIPTION :     Sample at the rate of a live stream client, or
+*                   at the measurement cadence without one
+*/
+void setSamplePeriod(){
+    uint32 ms = LiveStream_PeriodMs(Dormant_Enabled() ? 0u : Cadence_PeriodMs());
+    Scheduler_ChangePeriod(sampleTaskId, LpTimer_Now(), LpTimer_MsToTicks(ms));
+}
+
+/*******************************************************************
+* NAME :            void applySettings()
+*
+* DESCRIPTION :     Take the parameters of the unit on top of the
+*                   defaults of this firmware, at boot and after a
+*                   commit over GATT
+*/
+void applySettings(){
+    Settings_Cadence(&cadenceDefaults, &cadence);
+    Settings_AdvPolicy(&advPolicyDefaults, &advPolicy);
+}
+
+/*******************************************************************
+* NAME :            uint8 pollParticles()
 *
-* DESCRIPTION :     Read sensor measurement
+* DESCRIPTION :     Collect sensor packet bytes already in the UART
+*                   buffer, never waits. A packet with a wrong header
+*                   or checksum is dropped and the search for the
+*                   start character begins again
 * OUTPUTS :
-*       char* Sensor TX packet
+*       uint8 1 when a complete, valid packet is in senData
 */
-char* readParticles(){
-    int idx;
-    static char senData[32];
-    senData[0]=0x42;
-    while(Serial_UartGetChar()!= 0x42); // Wait for start character
-    for(idx=1;idx<32;idx++){ // Read TX packet
-        CyDelay(10); // Wait for data
-        senData[idx]=Serial_UartGetChar();// Get next byte
+uint8 pollParticles(){
+    while(Serial_SpiUartGetRxBufferSize()){
+        char c = Serial_UartGetChar(); // Get next byte
+        if(rxIdx==0 && c!=(char)PACKET_HEAD) continue; // Wait for start character
+        if(rxIdx==1 && c!=(char)PACKET_HEAD2){ // Not a packet header
+            rxIdx = (c==(char)PACKET_HEAD) ? 1u : 0u; // May be the next start character
+            continue;
+        }
+        senData[rxIdx++]=c;
+        if(rxIdx>=PACKET_LEN){
+            rxIdx=0;
+            if(packetValid()) return 1;
+        }
     }
-    return senData;
+    return 0;
+}
+
+/*******************************************************************
+* NAME :            uint8 packetValid()
+*
+* DESCRIPTION :     Check the checksum of the packet in senData, the
+*                   last two bytes hold the sum of all bytes before
+*                   them, high byte first
+* OUTPUTS :
+*       uint8 1 when the packet is intact
+*/
+uint8 packetValid(){
+    uint16 sum = 0;
+    uint8 i;
+    
+    for(i=0; i<PACKET_LEN-2; i++) sum += (uint8)senData[i];
+    return (sum==(uint16)((uint8)senData[PACKET_LEN-2]*256 + (uint8)senData[PACKET_LEN-1])) ? 1u : 0u;
 }
 
 /* [] END OF FILE */
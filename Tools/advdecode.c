@@ -0,0 +1,193 @@
+/* ========================================
+ * Air Quality Beacon, part of the hackAIR project.
+ * Freely available under CC BY 4.0
+ *
+ * Decode hackAIR advertisements on a PC. Reads one advertisement
+ * per line as hex (spaces and colons ignored), e.g. the data bytes
+ * printed by btmon, and prints the frame fields. Scan responses
+ * print the reading history, oldest first, see History.h. With the
+ * key of a unit, tagged frames are checked first and forged or
+ * corrupted ones are reported without decoding. AdvFrame.c and
+ * SipHash.c are all a receiver needs for that, AdvFrame_Verify().
+ *
+ *   gcc -DHACKAIR_HOST -I../Common -o advdecode advdecode.c ../Common/AdvFrame.c ../Common/SipHash.c ../Common/TxPower.c
+ *   echo 0201040B09416972204265616... | ./advdecode
+ *   ./advdecode -c 0x0059 < log.txt     (units configured with another company ID)
+ *   ./advdecode -k 000102030405060708090A0B0C0D0E0F < log.txt     (tagged frames)
+ *
+ * http://www.hackair.eu/
+*/
+#include <stdio.h>
+#include <ctype.h>
+#include <stdlib.h>
+#include "AdvFrame.h"
+#include "TxPower.h"
+#include "SipHash.h"
+
+static const char *sensorName(uint8 sensor){
+    switch(sensor){
+        case ADVFRAME_SENSOR_SEN0177:       return "SEN0177";
+        case ADVFRAME_SENSOR_SDS011:        return "SDS011";
+        case ADVFRAME_SENSOR_GP2Y1010:      return "GP2Y1010AU0F";
+        case ADVFRAME_SENSOR_DN7C3CA006:    return "DN7C3CA006";
+        case ADVFRAME_SENSOR_PPD42:         return "PPD42";
+        default:                            return "unknown";
+    }
+}
+
+/* 0.1 ug/m^3 fixed point, n/a for absent values */
+static void printPm(const char *name, uint16 v){
+    if(v == ADVFRAME_NA) printf(" %s=n/a", name);
+    else printf(" %s=%u.%u", name, v / 10u, v % 10u);
+}
+
+static void printFrame(const ADVFRAME_T *f){
+    unsigned long long bins = 0u;
+    unsigned i;
+    
+    printf("seq=%u sensor=%s health=0x%X flags=0x%X", f->seq, sensorName(f->sensor), f->health, f->flags);
+    switch(f->type){
+        case ADVFRAME_TYPE_MEASUREMENT:
+            printf(" measurement");
+            printPm("pm1", AdvFrame_GetPm(f->body, 0u));
+            printPm("pm2.5", AdvFrame_GetPm(f->body, 1u));
+            printPm("pm10", AdvFrame_GetPm(f->body, 2u));
+            if(AdvFrame_GetU16(f->body, 4u) != ADVFRAME_NA) printf(" raw=%u", AdvFrame_GetU16(f->body, 4u));
+            if(f->body[6] != ADVFRAME_BATTERY_NA) printf(" battery=%u%%", f->body[6]);
+            break;
+        case ADVFRAME_TYPE_ENERGY:
+            printf(" energy active=%.1f%% sleep=%.1f%% sensor=%.1f%% led=%.1f%% periph=%.1f%% charge=%.1fmAh duty=%.1f%%",
+                f->body[0] / 2.0, f->body[1] / 2.0, f->body[2] / 2.0, f->body[3] / 2.0, f->body[4] / 2.0,
+                AdvFrame_GetU16(f->body, 5u) / 10.0, f->body[7] / 10.0);
+            break;
+        case ADVFRAME_TYPE_SUPERVISOR:
+            printf(" supervisor fault_stage=%d faults=%u", (int)(f->body[0] >> 4) - 1, f->body[0] & 0x0Fu); // 3: loop check-in
+            for(i = 0u; i < 3u; i++) printf(" stage%u=%.2f/%.2fms", i, f->body[1u + 2u * i] / 4.0, f->body[2u + 2u * i] / 4.0);
+            printf(" wake_latency=%ums", f->body[7] * 10u);
+            break;
+        case ADVFRAME_TYPE_HISTOGRAM:
+            printf(" histogram pulses=%u bins=", f->body[0]);
+            for(i = 0u; i < 6u; i++) bins = (bins << 8) | f->body[1u + i];
+            for(i = 0u; i < 8u; i++){ // 6 bit bins, bin 0 in the top bits
+                printf("%s%u", (i != 0u) ? "," : "", (unsigned)((bins >> (42u - 6u * i)) & 0x3Fu));
+            }
+            break;
+        case ADVFRAME_TYPE_BEACON:
+            printf(" beacon committed=%u skipped=%u deferred=%u tx=%ddBm tx_current=%.1fmA radio=x%.2f",
+                AdvFrame_GetU16(f->body, 0u), AdvFrame_GetU16(f->body, 2u), AdvFrame_GetU16(f->body, 4u), (int8)f->body[6],
+                TxPower_CurrentUA(TxPower_LevelOf((int8)f->body[6])) / 1000.0,
+                TxPower_RadioPermille(TxPower_LevelOf((int8)f->body[6])) / 1000.0); // Radio load of the energy page, relative to 0dBm
+            if(f->body[7] == ADVFRAME_SCAN_REQ_NA) printf(" scan_requests=n/a");
+            else printf(" scan_requests=%u", f->body[7]);
+            break;
+        default:
+            printf(" type=%u", f->type);
+            break;
+    }
+    printf("\n");
+}
+
+/* Sign extend a 7 or 15 bit field */
+static int getField(const uint8 *p, unsigned *used, int isSigned){
+    int v;
+    
+    if(p[0] & 0x80u){
+        v = ((p[0] & 0x7F) << 8) | p[1];
+        if(isSigned && (v & 0x4000)) v -= 0x8000;
+        *used = 2u;
+    }else{
+        v = p[0];
+        if(isSigned && (v & 0x40)) v -= 0x80;
+        *used = 1u;
+    }
+    return v;
+}
+
+/* History structure of a scan response, 1 if found */
+static int printHistory(const uint8 rsp[], unsigned len){
+    int values[32];
+    int ages[32];
+    unsigned n = 0u;
+    unsigned i = 10u;
+    unsigned end;
+    
+    if((len < 10u) || (rsp[1] != ADVFRAME_AD_TYPE) ||
+       (rsp[2] != (uint8)(AdvFrame_Company() & 0xFFu)) || (rsp[3] != (uint8)(AdvFrame_Company() >> 8)) ||
+       (rsp[4] != ((ADVFRAME_VERSION << 4) | ADVFRAME_TYPE_HISTORY))) return 0;
+    end = rsp[0] + 1u;
+    if(end > len) end = len;
+    values[0] = (int16_t)((rsp[8] << 8) | rsp[9]);
+    ages[0] = rsp[7];
+    for(n = 1u; (i < end) && (n < 32u); n++){
+        unsigned used;
+        int secs = getField(&rsp[i], &used, 0);
+        i += used;
+        if(i >= end) break;
+        values[n] = values[n - 1u] - getField(&rsp[i], &used, 1);
+        i += used;
+        ages[n] = ages[n - 1u] + secs;
+    }
+    printf("history sensor=%s readings=%u", sensorName(rsp[5]), rsp[6]);
+    while(n-- > 0u) printf(" -%ds:%d", ages[n], values[n]);
+    printf("\n");
+    return 1;
+}
+
+/* Hex digits to bytes, spaces and colons ignored */
+static unsigned parseHex(const char *c, uint8 out[], unsigned max){
+    unsigned len = 0u;
+    int hi = -1;
+    
+    for(; (*c != '\0') && (len < max); c++){
+        if(!isxdigit((unsigned char)*c)) continue;
+        int v = isdigit((unsigned char)*c) ? (*c - '0') : (tolower((unsigned char)*c) - 'a' + 10);
+        if(hi < 0){
+            hi = v;
+        }else{
+            out[len++] = (uint8)((hi << 4) | v);
+            hi = -1;
+        }
+    }
+    return len;
+}
+
+int main(int argc, char *argv[]){
+    char line[256];
+    uint8 key[SIPHASH_KEY_LEN];
+    int keyed = 0;
+    int a;
+    
+    for(a = 1; (a + 1) < argc; a += 2){
+        if((argv[a][0] == '-') && (argv[a][1] == 'c')){
+            AdvFrame_SetLayout(ADVFRAME_OFFSET, (uint16)strtoul(argv[a + 1], NULL, 0));
+        }else if((argv[a][0] == '-') && (argv[a][1] == 'k')){
+            if(parseHex(argv[a + 1], key, SIPHASH_KEY_LEN) != SIPHASH_KEY_LEN){
+                fprintf(stderr, "key must be %u bytes of hex\n", SIPHASH_KEY_LEN);
+                return 1;
+            }
+            keyed = 1;
+        }
+    }
+    
+    while(fgets(line, sizeof(line), stdin) != NULL){
+        uint8 adv[64];
+        unsigned len = parseHex(line, adv, sizeof(adv));
+        ADVFRAME_T frame;
+        
+        if(len == 0u) continue;
+        if(keyed){ // Cheap check before anything else
+            uint8 tag = AdvFrame_Verify(adv, (uint8)len, key);
+            if(tag == ADVFRAME_TAG_BAD){
+                printf("bad tag, dropped\n");
+                continue;
+            }
+            if(tag == ADVFRAME_TAG_OK) printf("tag ok ");
+        }
+        if(AdvFrame_Decode(adv, (uint8)len, &frame)) printFrame(&frame);
+        else if(printHistory(adv, len)) continue;
+        else printf("no hackAIR v%u frame\n", ADVFRAME_VERSION);
+    }
+    return 0;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,142 @@
+/* ========================================
+ * Air Quality Beacon, part of the hackAIR project.
+ * Freely available under CC BY 4.0
+ *
+ * Stand-in client for the GATT history download on a PC. Reads the
+ * notifications of one or more transfers, one per line as hex, and
+ * prints the records, then the summary of each transfer with the
+ * throughput and the header bytes spent per record. Lines of
+ * gatttool --listen are taken as they are, only the bytes after
+ * "value:" count. With -t every line starts with its receive time
+ * in seconds, e.g. through ts %.s, and the throughput seen by the
+ * PC is printed next to the one of the unit. See HistoryService.h
+ * for the format.
+ *
+ *   gcc -DHACKAIR_HOST -I../Common -o histclient histclient.c
+ *   gatttool -b <unit> --char-write-req -a 0x000d -n 0100 --listen &
+ *   gatttool -b <unit> --char-write-req -a 0x000c -n 00000000
+ *   ./histclient < notifications.txt
+ *
+ * The command line gatttool keeps the default 23 byte MTU. For the
+ * full HISTORYSERVICE_MTU, exchange it in interactive mode first
+ * and log the session:
+ *
+ *   gatttool -b <unit> -I | grep --line-buffered value: > notifications.txt
+ *   > connect
+ *   > mtu 247
+ *   > char-write-req 0x000d 0100
+ *   > char-write-req 0x000c 00000000
+ *
+ * The summary line then shows mtu=247 and 59 records per
+ * notification.
+ *   ./histclient -q -t < timed.txt     (summaries only)
+ *
+ * http://www.hackair.eu/
+*/
+#include <stdio.h>
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+#include "HistoryService.h"
+
+/* Hex digits to bytes, spaces and colons ignored */
+static unsigned parseHex(const char *c, uint8 out[], unsigned max){
+    unsigned len = 0u;
+    int hi = -1;
+    
+    for(; (*c != '\0') && (len < max); c++){
+        if(!isxdigit((unsigned char)*c)) continue;
+        int v = isdigit((unsigned char)*c) ? (*c - '0') : (tolower((unsigned char)*c) - 'a' + 10);
+        if(hi < 0){
+            hi = v;
+        }else{
+            out[len++] = (uint8)((hi << 4) | v);
+            hi = -1;
+        }
+    }
+    return len;
+}
+
+static uint32 getBe(const uint8 *p, unsigned len){
+    uint32 v = 0u;
+    
+    while(len-- > 0u) v = (v << 8) | *p++;
+    return v;
+}
+
+/* Per transfer figures, from the summary of the unit */
+static void printSummary(const uint8 pkt[], double seconds){
+    uint32 records = getBe(&pkt[8], 4u);
+    uint32 ntf = getBe(&pkt[12], 2u);
+    uint32 ms = getBe(&pkt[14], 4u);
+    uint32 mtu = getBe(&pkt[18], 2u);
+    uint32 data = records * HISTORYSERVICE_RECORD_LEN;
+    uint32 headers = (ntf + 1u) * (HISTORYSERVICE_HEADER_LEN + HISTORYSERVICE_ATT_HDR + HISTORYSERVICE_L2CAP_HDR) +
+                     HISTORYSERVICE_SUMMARY_LEN; // The closing notification counts as overhead
+    
+    printf("done records=%u notifications=%u mtu=%u records_per_notification=%u time=%ums",
+        records, ntf, mtu, (mtu - HISTORYSERVICE_ATT_HDR - HISTORYSERVICE_HEADER_LEN) / HISTORYSERVICE_RECORD_LEN, ms);
+    if(ms != 0u) printf(" throughput=%.0fB/s records=%.1f/s", data * 1000.0 / ms, records * 1000.0 / ms);
+    if(seconds > 0.0) printf(" received=%.0fB/s", data / seconds);
+    if(records != 0u) printf(" overhead=%.2fB/record efficiency=%.1f%%", (double)headers / records,
+        100.0 * data / (data + headers));
+    printf("\n");
+}
+
+int main(int argc, char *argv[]){
+    char line[1024];
+    int quiet = 0;
+    int timed = 0;
+    int a;
+    uint32 expect = 0u;
+    int started = 0;
+    double first = 0.0;
+    double last = 0.0;
+    
+    for(a = 1; a < argc; a++){
+        if(strcmp(argv[a], "-q") == 0) quiet = 1;
+        else if(strcmp(argv[a], "-t") == 0) timed = 1;
+    }
+    
+    while(fgets(line, sizeof(line), stdin) != NULL){
+        uint8 pkt[512];
+        const char *hex = strstr(line, "value:");
+        char *rest = line;
+        double at = 0.0;
+        unsigned len;
+        uint32 seq;
+        uint32 age;
+        unsigned i;
+        
+        if(timed) at = strtod(line, &rest);
+        len = parseHex((hex != NULL) ? (hex + 6) : rest, pkt, sizeof(pkt));
+        if(len < HISTORYSERVICE_HEADER_LEN) continue;
+        seq = getBe(pkt, 4u);
+        age = getBe(&pkt[4], 4u);
+        if(!started){
+            first = at;
+            started = 1;
+        }else if(seq != expect){
+            printf("skipped %u..%u, overwritten\n", expect, seq - 1u);
+        }
+        last = at;
+        
+        if(age == HISTORYSERVICE_AGE_END){
+            if(len >= (HISTORYSERVICE_HEADER_LEN + HISTORYSERVICE_SUMMARY_LEN)) printSummary(pkt, timed ? (last - first) : 0.0);
+            else printf("done\n");
+            started = 0;
+            continue;
+        }
+        for(i = HISTORYSERVICE_HEADER_LEN; (i + HISTORYSERVICE_RECORD_LEN) <= len; i += HISTORYSERVICE_RECORD_LEN){
+            uint32 gap = getBe(&pkt[i + 2u], 2u);
+            
+            if(i != HISTORYSERVICE_HEADER_LEN) age = (gap < age) ? (age - gap) : 0u;
+            if(!quiet) printf("%u -%us %d\n", seq, age, (int16)getBe(&pkt[i], 2u));
+            seq++;
+        }
+        expect = seq;
+    }
+    return 0;
+}
+
+/* [] END OF FILE */
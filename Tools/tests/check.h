@@ -0,0 +1,25 @@
+/* ========================================
+ * Air Quality Beacon, part of the hackAIR project.
+ * Freely available under CC BY 4.0
+ *
+ * Minimal checks for the host tests of the hardware free modules in
+ * Common. CHECK() reports a failed expression with its line and the
+ * test goes on, CHECK_DONE() is the exit code of main().
+ *
+ * http://www.hackair.eu/
+*/
+#ifndef CHECK_H
+#define CHECK_H
+
+#include <stdio.h>
+
+static int checkFailures;
+
+#define CHECK(expr)     do{ if(!(expr)){ checkFailures++; printf("%s:%d: %s\n", __FILE__, __LINE__, #expr); } }while(0)
+#define CHECK_EQ(a, b)  do{ unsigned long long va_ = (unsigned long long)(a), vb_ = (unsigned long long)(b); \
+                            if(va_ != vb_){ checkFailures++; printf("%s:%d: %s == %s, 0x%llx != 0x%llx\n", __FILE__, __LINE__, #a, #b, va_, vb_); } }while(0)
+#define CHECK_DONE()    (printf("%s: %s\n", __FILE__, (checkFailures == 0) ? "ok" : "FAILED"), (checkFailures == 0) ? 0 : 1)
+
+#endif /* CHECK_H */
+
+/* [] END OF FILE */
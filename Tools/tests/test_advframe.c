@@ -0,0 +1,212 @@
+/* ========================================
+ * Air Quality Beacon, part of the hackAIR project.
+ * Freely available under CC BY 4.0
+ *
+ * AdvFrame.c round trips: PM codes and their worst case error over
+ * the whole 16 bit range, measurement bodies, frames
+ * through AdvFrame_Encode() and AdvFrame_Decode() with the sequence
+ * number and the tag, and AdvFrame_Verify() on good, corrupted and
+ * untagged frames.
+ *
+ * http://www.hackair.eu/
+*/
+#include <string.h>
+#include "check.h"
+#include "AdvFrame.h"
+
+#define ADV_MAX     (ADVFRAME_OFFSET + ADVFRAME_LEN + ADVFRAME_TAG_LEN)
+
+/* Flags and the "Air Beacon" name, ADVFRAME_OFFSET bytes */
+static const uint8 prefix[ADVFRAME_OFFSET] = {
+    0x02u, 0x01u, 0x04u, 0x0Bu, 0x09u, 'A', 'i', 'r', ' ', 'B', 'e', 'a', 'c', 'o', 'n'
+};
+static const uint8 key[16] = {
+    0x00u, 0x01u, 0x02u, 0x03u, 0x04u, 0x05u, 0x06u, 0x07u, 0x08u, 0x09u, 0x0Au, 0x0Bu, 0x0Cu, 0x0Du, 0x0Eu, 0x0Fu
+};
+
+static const uint8 otherKey[16] = {
+    0x0Fu, 0x0Eu, 0x0Du, 0x0Cu, 0x0Bu, 0x0Au, 0x09u, 0x08u, 0x07u, 0x06u, 0x05u, 0x04u, 0x03u, 0x02u, 0x01u, 0x00u
+};
+
+static void pmCodes(void){
+    uint32 v;
+    uint16 c;
+    
+    /* Exact below 6.4ug/m^3, then on the grid of each exponent */
+    for(v = 0u; v < 64u; v++) CHECK_EQ(AdvFrame_PmEncode((uint16)v), v);
+    CHECK_EQ(AdvFrame_PmEncode(64u), 0x40u);
+    CHECK_EQ(AdvFrame_PmEncode(127u), 0x7Fu);
+    CHECK_EQ(AdvFrame_PmEncode(128u), 0x80u);
+    CHECK_EQ(AdvFrame_PmEncode(129u), 0x81u);  // 129 rounds up to 130
+    CHECK_EQ(AdvFrame_PmDecode(0x81u), 130u);
+    CHECK_EQ(AdvFrame_PmEncode(255u), 0xC0u);  // Carries into the next exponent
+    CHECK_EQ(AdvFrame_PmEncode(ADVFRAME_NA), ADVFRAME_PM_NA);
+    CHECK_EQ(AdvFrame_PmDecode(ADVFRAME_PM_NA), ADVFRAME_NA);
+    
+    /* Every code in use decodes to a value that encodes back to it */
+    for(c = 0u; c <= 704u; c++){
+        uint16 value = AdvFrame_PmDecode(c);
+        
+        if(value < 0xFFFEu) CHECK_EQ(AdvFrame_PmEncode(value), c);
+    }
+    
+    /* Codes never go down as the value goes up */
+    for(v = 1u; v < ADVFRAME_NA; v++){
+        if(AdvFrame_PmEncode((uint16)v) < AdvFrame_PmEncode((uint16)(v - 1u))){
+            CHECK_EQ(v, 0u);
+            break;
+        }
+    }
+}
+
+/* Worst case is half a step of exponent 2, 1/129 at 12.9ug/m^3 */
+static void pmError(void){
+    uint32 v;
+    uint32 worstV = 1u;
+    uint32 worstErr = 0u;
+    uint16 maxCode = 0u;
+    
+    for(v = 1u; v < ADVFRAME_NA; v++){
+        uint16 code = AdvFrame_PmEncode((uint16)v);
+        uint32 back = AdvFrame_PmDecode(code);
+        uint32 err = (back > v) ? (back - v) : (v - back);
+        
+        if(code > maxCode) maxCode = code;
+        if((err * worstV) > (worstErr * v)){ // err / v above the worst so far
+            worstErr = err;
+            worstV = v;
+        }
+    }
+    CHECK_EQ(worstV, 129u);
+    CHECK_EQ(worstErr, 1u);
+    CHECK_EQ(maxCode, 704u);
+    CHECK((worstErr * 1000u) < (worstV * 8u)); // Within 0.8%
+}
+
+static void measurementBody(void){
+    uint8 body[ADVFRAME_BODY_LEN];
+    
+    AdvFrame_PutMeasurement(body, 12u, 345u, ADVFRAME_NA, 0xBEEFu, 87u);
+    CHECK_EQ(AdvFrame_GetPm(body, 0u), 12u);
+    CHECK_EQ(AdvFrame_GetPm(body, 1u), AdvFrame_PmDecode(AdvFrame_PmEncode(345u)));
+    CHECK_EQ(AdvFrame_GetPm(body, 2u), ADVFRAME_NA);
+    CHECK_EQ(AdvFrame_GetU16(body, 4u), 0xBEEFu);
+    CHECK_EQ(body[6], 87u);
+    CHECK_EQ(body[3] & 0x03u, 0u);
+    CHECK_EQ(body[7], 0u);
+}
+
+static void frames(void){
+    uint8 adv[ADV_MAX];
+    ADVFRAME_T in;
+    ADVFRAME_T out;
+    uint8 len;
+    uint8 tag[ADVFRAME_TAG_LEN];
+    
+    memset(adv, 0, sizeof(adv));
+    memcpy(adv, prefix, sizeof(prefix));
+    memset(&in, 0, sizeof(in));
+    in.type = ADVFRAME_TYPE_MEASUREMENT;
+    in.sensor = ADVFRAME_SENSOR_SDS011;
+    in.health = ADVFRAME_HEALTH_WARMUP;
+    in.flags = ADVFRAME_FLAG_BURST;
+    AdvFrame_PutMeasurement(in.body, 100u, 200u, 300u, ADVFRAME_NA, ADVFRAME_BATTERY_NA);
+    
+    /* Untagged */
+    len = AdvFrame_Encode(&in, adv);
+    CHECK_EQ(len, ADVFRAME_OFFSET + ADVFRAME_LEN);
+    CHECK_EQ(in.seq, 1u);
+    CHECK(AdvFrame_Decode(adv, len, &out));
+    CHECK_EQ(out.type, in.type);
+    CHECK_EQ(out.sensor, in.sensor);
+    CHECK_EQ(out.seq, in.seq);
+    CHECK_EQ(out.health, in.health);
+    CHECK_EQ(out.flags, in.flags);
+    CHECK(memcmp(out.body, in.body, ADVFRAME_BODY_LEN) == 0);
+    CHECK_EQ(AdvFrame_Verify(adv, len, key), ADVFRAME_TAG_NONE);
+    
+    /* A repeated frame keeps its sequence number, a changed one moves on */
+    (void)AdvFrame_Encode(&in, adv);
+    CHECK_EQ(in.seq, 1u);
+    in.body[6] = 50u;
+    (void)AdvFrame_Encode(&in, adv);
+    CHECK_EQ(in.seq, 2u);
+    
+    /* Truncated or another company ID, no frame */
+    CHECK(!AdvFrame_Decode(adv, (uint8)(len - 1u), &out));
+    AdvFrame_SetLayout(ADVFRAME_OFFSET, 0x0059u);
+    CHECK(!AdvFrame_Decode(adv, len, &out));
+    AdvFrame_SetLayout(ADVFRAME_OFFSET, ADVFRAME_COMPANY_ID);
+    
+    /* Tagged, the tag stays with a repeated frame */
+    AdvFrame_SetKey(key);
+    len = AdvFrame_Encode(&in, adv);
+    CHECK_EQ(len, ADV_MAX);
+    CHECK_EQ(adv[ADVFRAME_OFFSET], ADVFRAME_LEN + ADVFRAME_TAG_LEN - 1u);
+    CHECK(AdvFrame_Decode(adv, len, &out));
+    CHECK_EQ(out.seq, in.seq);
+    CHECK_EQ(AdvFrame_Verify(adv, len, key), ADVFRAME_TAG_OK);
+    memcpy(tag, &adv[ADVFRAME_OFFSET + ADVFRAME_LEN], ADVFRAME_TAG_LEN);
+    (void)AdvFrame_Encode(&in, adv);
+    CHECK(memcmp(tag, &adv[ADVFRAME_OFFSET + ADVFRAME_LEN], ADVFRAME_TAG_LEN) == 0);
+    
+    /* Any flipped bit from the company ID on breaks the tag */
+    adv[ADVFRAME_OFFSET + 10u] ^= 0x01u;
+    CHECK_EQ(AdvFrame_Verify(adv, len, key), ADVFRAME_TAG_BAD);
+    adv[ADVFRAME_OFFSET + 10u] ^= 0x01u;
+    adv[ADVFRAME_OFFSET + 6u] ^= 0x80u;
+    CHECK_EQ(AdvFrame_Verify(adv, len, key), ADVFRAME_TAG_BAD);
+    adv[ADVFRAME_OFFSET + 6u] ^= 0x80u;
+    CHECK_EQ(AdvFrame_Verify(adv, len, otherKey), ADVFRAME_TAG_BAD);
+    CHECK_EQ(AdvFrame_Verify(adv, len, key), ADVFRAME_TAG_OK);
+    AdvFrame_SetKey(0);
+}
+
+/* Pages taking turns keep their own sequence number and tag */
+static void pages(void){
+    uint8 adv[ADV_MAX];
+    uint8 tag[ADVFRAME_TAG_LEN];
+    ADVFRAME_T a;
+    ADVFRAME_T b;
+    uint8 i;
+    
+    memset(adv, 0, sizeof(adv));
+    memcpy(adv, prefix, sizeof(prefix));
+    memset(&a, 0, sizeof(a));
+    memset(&b, 0, sizeof(b));
+    a.type = ADVFRAME_TYPE_MEASUREMENT;
+    b.type = ADVFRAME_TYPE_ENERGY;
+    b.body[0] = 1u;
+    AdvFrame_SetKey(key);
+    (void)AdvFrame_Encode(&a, adv);
+    memcpy(tag, &adv[ADVFRAME_OFFSET + ADVFRAME_LEN], ADVFRAME_TAG_LEN);
+    for(i = 0u; i < 4u; i++){
+        (void)AdvFrame_Encode(&b, adv);
+        CHECK_EQ(b.seq, 1u);
+        (void)AdvFrame_Encode(&a, adv);
+        CHECK_EQ(a.seq, 1u);
+        CHECK(memcmp(tag, &adv[ADVFRAME_OFFSET + ADVFRAME_LEN], ADVFRAME_TAG_LEN) == 0);
+    }
+    b.body[0] = 2u;
+    (void)AdvFrame_Encode(&b, adv);
+    CHECK_EQ(b.seq, 2u);
+    CHECK_EQ(AdvFrame_Verify(adv, ADV_MAX, key), ADVFRAME_TAG_OK);
+    
+    /* A new key makes the tags again, the sequence numbers stay */
+    AdvFrame_SetKey(otherKey);
+    (void)AdvFrame_Encode(&a, adv);
+    CHECK_EQ(a.seq, 1u);
+    CHECK_EQ(AdvFrame_Verify(adv, ADV_MAX, otherKey), ADVFRAME_TAG_OK);
+    AdvFrame_SetKey(0);
+}
+
+int main(void){
+    pmCodes();
+    pmError();
+    measurementBody();
+    frames();
+    pages();
+    return CHECK_DONE();
+}
+
+/* [] END OF FILE */
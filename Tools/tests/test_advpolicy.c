@@ -0,0 +1,66 @@
+/* ========================================
+ * Air Quality Beacon, part of the hackAIR project.
+ * Freely available under CC BY 4.0
+ *
+ * AdvPolicy.c transitions: fast cycles after a significant change,
+ * doubling back off up to the maximum, absolute and relative
+ * thresholds and the cap while scan requests come in.
+ *
+ * http://www.hackair.eu/
+*/
+#include "check.h"
+#include "AdvPolicy.h"
+
+static const ADVPOLICY_CONFIG_T config = {
+    ADVPOLICY_DEFAULT_MIN, ADVPOLICY_DEFAULT_MAX, 10u, ADVPOLICY_DEFAULT_REL, ADVPOLICY_DEFAULT_FAST
+};
+static const ADVPOLICY_CONFIG_T slowConfig = {0x0640u, 0x1900u, 10u, 200u, 0u};
+
+int main(void){
+    static const uint16 backOff[] = {0x0140u, 0x0280u, 0x0500u, 0x0A00u, 0x1400u, 0x1900u, 0x1900u};
+    uint8 i;
+    
+    AdvPolicy_Init(&config);
+    CHECK_EQ(AdvPolicy_Interval(), ADVPOLICY_DEFAULT_MIN);
+    
+    /* First reading is a change from 0, then fastCycles at the minimum */
+    CHECK_EQ(AdvPolicy_Update(100u), ADVPOLICY_DEFAULT_MIN);
+    for(i = 0u; i < ADVPOLICY_DEFAULT_FAST; i++) CHECK_EQ(AdvPolicy_Update(105u), ADVPOLICY_DEFAULT_MIN);
+    
+    /* Stable, doubling up to the maximum and staying there */
+    for(i = 0u; i < (sizeof(backOff) / sizeof(backOff[0])); i++) CHECK_EQ(AdvPolicy_Update(95u), backOff[i]);
+    
+    /* 19 below the 20% of the reference is stable, 20 is a change */
+    CHECK_EQ(AdvPolicy_Update(119u), ADVPOLICY_DEFAULT_MAX);
+    CHECK_EQ(AdvPolicy_Update(120u), ADVPOLICY_DEFAULT_MIN);
+    
+    /* Near 0 the absolute threshold counts */
+    AdvPolicy_Init(&config);
+    for(i = 0u; i < 12u; i++) (void)AdvPolicy_Update(5u);
+    CHECK_EQ(AdvPolicy_Update(9u), ADVPOLICY_DEFAULT_MAX);
+    CHECK_EQ(AdvPolicy_Update(10u), ADVPOLICY_DEFAULT_MIN);
+    
+    /* Scanned: capped at ADVPOLICY_ATTENDED_MAX, backs off once quiet */
+    for(i = 0u; i < 12u; i++) (void)AdvPolicy_Update(12u);
+    CHECK_EQ(AdvPolicy_Interval(), ADVPOLICY_DEFAULT_MAX);
+    AdvPolicy_ScanQuiet(ADVPOLICY_QUIET_SECS - 1u);
+    CHECK_EQ(AdvPolicy_Update(12u), ADVPOLICY_ATTENDED_MAX);
+    CHECK_EQ(AdvPolicy_Update(12u), ADVPOLICY_ATTENDED_MAX);
+    CHECK_EQ(AdvPolicy_Update(30u), ADVPOLICY_DEFAULT_MIN); // Changes still go fast
+    AdvPolicy_ScanQuiet(ADVPOLICY_QUIET_SECS);
+    for(i = 0u; i < 12u; i++) (void)AdvPolicy_Update(30u);
+    CHECK_EQ(AdvPolicy_Interval(), ADVPOLICY_DEFAULT_MAX);
+    
+    /* A unit minimum above the cap is kept while scanned */
+    AdvPolicy_Init(&slowConfig);
+    AdvPolicy_ScanQuiet(0u);
+    CHECK_EQ(AdvPolicy_Update(100u), 0x0640u);
+    CHECK_EQ(AdvPolicy_Update(100u), 0x0640u);
+    AdvPolicy_ScanQuiet(ADVPOLICY_QUIET_SECS);
+    CHECK_EQ(AdvPolicy_Update(100u), 0x0C80u);
+    CHECK_EQ(AdvPolicy_Update(100u), 0x1900u);
+    
+    return CHECK_DONE();
+}
+
+/* [] END OF FILE */
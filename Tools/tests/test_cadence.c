@@ -0,0 +1,54 @@
+/* ========================================
+ * Air Quality Beacon, part of the hackAIR project.
+ * Freely available under CC BY 4.0
+ *
+ * Cadence.c transitions: the burst after power up, bursts started
+ * by the level and by the step between readings, and the fall back
+ * to the slow period after burstSamples quiet readings.
+ *
+ * http://www.hackair.eu/
+*/
+#include "check.h"
+#include "Cadence.h"
+
+#define SLOW_MS     (60000u)
+#define BURST_MS    (5000u)
+
+static const CADENCE_CONFIG_T config = {SLOW_MS, BURST_MS, 500u, 100u, 3u};
+
+int main(void){
+    uint8 i;
+    
+    /* Power up starts in a burst */
+    Cadence_Init(&config);
+    CHECK(Cadence_InBurst());
+    CHECK_EQ(Cadence_PeriodMs(), BURST_MS);
+    CHECK_EQ(Cadence_Update(50u), BURST_MS);
+    CHECK_EQ(Cadence_Update(50u), BURST_MS);
+    CHECK_EQ(Cadence_Update(50u), SLOW_MS);
+    CHECK(!Cadence_InBurst());
+    
+    /* A step just under the rate threshold stays slow, at it bursts */
+    CHECK_EQ(Cadence_Update(149u), SLOW_MS);
+    CHECK_EQ(Cadence_Update(249u), BURST_MS);
+    for(i = 0u; i < 2u; i++) CHECK_EQ(Cadence_Update(249u), BURST_MS);
+    CHECK_EQ(Cadence_Update(249u), SLOW_MS);
+    
+    /* Falling steps count too */
+    CHECK_EQ(Cadence_Update(149u), BURST_MS);
+    for(i = 0u; i < 3u; i++) (void)Cadence_Update(149u);
+    CHECK_EQ(Cadence_PeriodMs(), SLOW_MS);
+    
+    /* At or above the level every reading restarts the burst */
+    CHECK_EQ(Cadence_Update(500u), BURST_MS);
+    for(i = 0u; i < 10u; i++) CHECK_EQ(Cadence_Update(500u), BURST_MS);
+    
+    /* A quiet reading mid burst does not restart it */
+    CHECK_EQ(Cadence_Update(450u), BURST_MS);
+    CHECK_EQ(Cadence_Update(450u), BURST_MS);
+    CHECK_EQ(Cadence_Update(450u), SLOW_MS);
+    
+    return CHECK_DONE();
+}
+
+/* [] END OF FILE */
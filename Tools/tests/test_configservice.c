@@ -0,0 +1,43 @@
+/* ========================================
+ * Air Quality Beacon, part of the hackAIR project.
+ * Freely available under CC BY 4.0
+ *
+ * ConfigService.h: what a stage command from any central may touch.
+ * The measurement parameters are accepted, the flags, TX power,
+ * advertising layout and tag key are refused.
+ *
+ * http://www.hackair.eu/
+*/
+#include "check.h"
+#include "ConfigService.h"
+
+int main(void){
+    unsigned off;
+    
+    /* Measurement parameters, one at a time and as a whole */
+    for(off = 2u; off < 16u; off++) CHECK(CONFIGSERVICE_STAGEABLE(off, 1u));
+    CHECK(CONFIGSERVICE_STAGEABLE(2u, 14u));
+    CHECK(CONFIGSERVICE_STAGEABLE(12u, 4u));
+    
+    /* Flags byte, non scannable or stealth from a drive-by connection */
+    CHECK(!CONFIGSERVICE_STAGEABLE(0u, 1u));
+    CHECK(!CONFIGSERVICE_STAGEABLE(0u, 16u));
+    
+    /* TX power levels */
+    CHECK(!CONFIGSERVICE_STAGEABLE(1u, 1u));
+    CHECK(!CONFIGSERVICE_STAGEABLE(1u, 3u));
+    
+    /* Running past the parameters into the advertising layout */
+    CHECK(!CONFIGSERVICE_STAGEABLE(14u, 3u));
+    CHECK(!CONFIGSERVICE_STAGEABLE(15u, 2u));
+    for(off = 16u; off < 48u; off++) CHECK(!CONFIGSERVICE_STAGEABLE(off, 1u));
+    
+    /* Tag key, no byte of it and not the whole key */
+    for(off = CONFIGSERVICE_KEY_START; off < CONFIGSERVICE_KEY_END; off++) CHECK(!CONFIGSERVICE_STAGEABLE(off, 1u));
+    CHECK(!CONFIGSERVICE_STAGEABLE(CONFIGSERVICE_KEY_START, 16u));
+    CHECK(!CONFIGSERVICE_STAGEABLE(255u, 18u));
+    
+    return CHECK_DONE();
+}
+
+/* [] END OF FILE */
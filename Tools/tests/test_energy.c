@@ -0,0 +1,74 @@
+/* ========================================
+ * Air Quality Beacon, part of the hackAIR project.
+ * Freely available under CC BY 4.0
+ *
+ * Energy.c on a virtual clock: residency per window across the LF
+ * timer wrap, charge from the current table, scaled loads and the
+ * advertised frame.
+ *
+ * http://www.hackair.eu/
+*/
+#include "check.h"
+#include "Energy.h"
+
+#define TICKS_PER_SEC   (32768u)
+#define TICKS_PER_HOUR  (TICKS_PER_SEC * 3600u)
+#define NEAR_WRAP       (0xFFFFFF00u)
+
+/* uA, active sleep deepsleep sensor LED periph radio */
+static const uint32 table[ENERGY_STATES] = {3000u, 1000u, 0u, 20000u, 2000u, 500u, 100u};
+
+int main(void){
+    uint8 frame[ENERGY_FRAME_LEN];
+    uint32 t = NEAR_WRAP;
+    
+    /* Nothing before Energy_Start() */
+    Energy_LoadOn(ENERGY_SENSOR, t);
+    CHECK_EQ(Energy_ChargeUAh(t), 0u);
+    
+    /* Window of 1000 ticks across the wrap: 250 active, 750 sleep */
+    Energy_Start(table, t);
+    Energy_SetCpu(ENERGY_CPU_SLEEP, t + 250u);
+    Energy_LoadOn(ENERGY_LED, t + 500u);
+    CHECK_EQ(Energy_ResidencyPermille(ENERGY_CPU_ACTIVE, t + 1000u), 250u);
+    CHECK_EQ(Energy_ResidencyPermille(ENERGY_CPU_SLEEP, t + 1000u), 750u);
+    CHECK_EQ(Energy_ResidencyPermille(ENERGY_LED, t + 1000u), 500u);
+    CHECK_EQ(Energy_ResidencyPermille(ENERGY_SENSOR, t + 1000u), 0u);
+    Energy_WriteFrame(frame, t + 1000u);
+    CHECK_EQ(frame[0], 50u);    // 0.5% steps
+    CHECK_EQ(frame[1], 150u);
+    CHECK_EQ(frame[3], 100u);
+    
+    /* A new window starts from zero, running states carry on */
+    t += 1000u;
+    Energy_LoadOff(ENERGY_LED, t);
+    Energy_ResetWindow(t);
+    CHECK_EQ(Energy_ResidencyPermille(ENERGY_CPU_SLEEP, t + 100u), 1000u);
+    CHECK_EQ(Energy_ResidencyPermille(ENERGY_LED, t + 100u), 0u);
+    
+    /* One hour each: sleep 1000uA, then deep sleep with the sensor 20000uA */
+    Energy_Start(table, 0u);
+    Energy_SetCpu(ENERGY_CPU_SLEEP, 0u);
+    Energy_SetCpu(ENERGY_CPU_DEEPSLEEP, TICKS_PER_HOUR);
+    CHECK_EQ(Energy_ChargeUAh(TICKS_PER_HOUR), 1000u);
+    Energy_LoadOn(ENERGY_SENSOR, TICKS_PER_HOUR);
+    Energy_LoadOff(ENERGY_SENSOR, 2u * TICKS_PER_HOUR);
+    CHECK_EQ(Energy_ChargeUAh(2u * TICKS_PER_HOUR), 21000u);
+    Energy_WriteFrame(frame, 2u * TICKS_PER_HOUR);
+    CHECK_EQ(((uint16)frame[5] << 8) | frame[6], 210u); // 0.1mAh
+    
+    /* Radio at a quarter of its table current for half an hour */
+    Energy_Start(table, 0u);
+    Energy_SetCpu(ENERGY_CPU_DEEPSLEEP, 0u);
+    Energy_ScaleLoad(ENERGY_RADIO, 250u, 0u);
+    Energy_LoadOn(ENERGY_RADIO, 0u);
+    CHECK_EQ(Energy_ChargeUAh(TICKS_PER_HOUR / 2u), 12u);
+    
+    /* ILO trimmed slow, the same ticks are more time */
+    Energy_SetTickRate(TICKS_PER_SEC / 2u);
+    CHECK_EQ(Energy_ChargeUAh(TICKS_PER_HOUR / 2u), 25u);
+    
+    return CHECK_DONE();
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,76 @@
+/* ========================================
+ * Air Quality Beacon, part of the hackAIR project.
+ * Freely available under CC BY 4.0
+ *
+ * Scheduler.c on a virtual clock across the 32 bit wrap of the LF
+ * timer: due times, re-phasing of late periodic tasks, period
+ * changes, one shots and the duty cycle.
+ *
+ * http://www.hackair.eu/
+*/
+#include "check.h"
+#include "Scheduler.h"
+
+#define NEAR_WRAP   (0xFFFFFF00u)
+
+static unsigned periodicRuns;
+static unsigned oneShotRuns;
+
+static void periodic(void){ periodicRuns++; }
+static void oneShot(void){ oneShotRuns++; }
+
+int main(void){
+    uint8 p = Scheduler_Add(periodic, NEAR_WRAP, 0x200u, 0x100u); // First due at 0x100, after the wrap
+    uint8 o = Scheduler_Add(oneShot, NEAR_WRAP, 0u, 0u);
+    
+    CHECK(p != SCHEDULER_NO_TASK);
+    CHECK(o != SCHEDULER_NO_TASK);
+    
+    /* Due now, before the wrap */
+    CHECK_EQ(Scheduler_NextDue(NEAR_WRAP), NEAR_WRAP);
+    Scheduler_Dispatch(NEAR_WRAP);
+    CHECK_EQ(oneShotRuns, 1u);
+    CHECK_EQ(periodicRuns, 0u);
+    CHECK(!Scheduler_IsArmed(o));
+    
+    /* A due time past the wrap is in the future, not overdue */
+    CHECK_EQ(Scheduler_NextDue(0xFFFFFFF0u), 0x100u);
+    Scheduler_Dispatch(0xFFFFFFF0u);
+    Scheduler_Dispatch(0x000000FFu);
+    CHECK_EQ(periodicRuns, 0u);
+    Scheduler_Dispatch(0x100u);
+    CHECK_EQ(periodicRuns, 1u);
+    CHECK_EQ(Scheduler_NextDue(0x100u), 0x200u);
+    
+    /* Late by more than a period, re-phased instead of run back to back */
+    Scheduler_Dispatch(0x550u);
+    CHECK_EQ(periodicRuns, 2u);
+    CHECK_EQ(Scheduler_NextDue(0x550u), 0x650u);
+    Scheduler_Dispatch(0x551u);
+    CHECK_EQ(periodicRuns, 2u);
+    
+    /* Unchanged period keeps the phase, a new one starts from now */
+    Scheduler_ChangePeriod(p, 0x600u, 0x100u);
+    CHECK_EQ(Scheduler_NextDue(0x600u), 0x650u);
+    Scheduler_ChangePeriod(p, 0x600u, 0x80u);
+    CHECK_EQ(Scheduler_NextDue(0x600u), 0x680u);
+    
+    /* One shot re-armed across the wrap */
+    Scheduler_Stop(p);
+    Scheduler_Trigger(o, 0xFFFFFFFFu, 2u);
+    CHECK_EQ(Scheduler_NextDue(0xFFFFFFFFu), 1u);
+    Scheduler_Dispatch(1u);
+    CHECK_EQ(oneShotRuns, 2u);
+    CHECK_EQ(Scheduler_NextDue(1u), 1u + SCHEDULER_MAX_SLEEP);
+    
+    /* Duty cycle over a window that wraps */
+    Scheduler_ResetStats(NEAR_WRAP);
+    Scheduler_AddSleep(750u);
+    CHECK_EQ(Scheduler_DutyPermille(NEAR_WRAP + 1000u), 250u);
+    Scheduler_AddSleep(2000u);
+    CHECK_EQ(Scheduler_DutyPermille(NEAR_WRAP + 1000u), 0u);
+    
+    return CHECK_DONE();
+}
+
+/* [] END OF FILE */
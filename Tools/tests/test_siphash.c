@@ -0,0 +1,49 @@
+/* ========================================
+ * Air Quality Beacon, part of the hackAIR project.
+ * Freely available under CC BY 4.0
+ *
+ * SipHash.c against the vectors of the SipHash-2-4 reference
+ * implementation: key 00 01 .. 0F, message 00 01 .. of each length.
+ * The lengths cover an empty message, partial and whole 8 byte
+ * blocks and the longest one listed.
+ *
+ * http://www.hackair.eu/
+*/
+#include "check.h"
+#include "SipHash.h"
+
+typedef struct
+{
+    uint8 len;
+    uint64 hash;
+} VECTOR_T;
+
+static const VECTOR_T vectors[] = {
+    { 0u, 0x726fdb47dd0e0e31uLL},
+    { 1u, 0x74f839c593dc67fduLL},
+    { 7u, 0xab0200f58b01d137uLL},
+    { 8u, 0x93f5f5799a932462uLL},
+    {15u, 0xa129ca6149be45e5uLL},
+    {16u, 0x3f2acc7f57c29bdbuLL},
+    {63u, 0x958a324ceb064572uLL},
+};
+
+int main(void){
+    uint8 key[SIPHASH_KEY_LEN];
+    uint8 data[64];
+    uint8 i;
+    
+    for(i = 0u; i < SIPHASH_KEY_LEN; i++) key[i] = i;
+    for(i = 0u; i < sizeof(data); i++) data[i] = i;
+    for(i = 0u; i < (sizeof(vectors) / sizeof(vectors[0])); i++){
+        CHECK_EQ(SipHash_24(key, data, vectors[i].len), vectors[i].hash);
+    }
+    
+    /* The key matters */
+    key[15] ^= 0x80u;
+    CHECK(SipHash_24(key, data, 15u) != 0xa129ca6149be45e5uLL);
+    
+    return CHECK_DONE();
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,57 @@
+/* ========================================
+ * Air Quality Beacon, part of the hackAIR project.
+ * Freely available under CC BY 4.0
+ *
+ * TxPower.c: the level picked from the configuration byte, dBm to
+ * level and back for receivers, and the radio load scaling of the
+ * energy report.
+ *
+ * http://www.hackair.eu/
+*/
+#include "check.h"
+#include "TxPower.h"
+
+int main(void){
+    uint8 level;
+    
+    /* Configuration nibbles, 0 keeps 0dBm, the burst one only when set */
+    CHECK_EQ(TxPower_Level(0x00u, 0u), TXPOWER_LEVEL_0DBM);
+    CHECK_EQ(TxPower_Level(0x00u, 1u), TXPOWER_LEVEL_0DBM);
+    CHECK_EQ(TxPower_Level(0x81u, 0u), TXPOWER_LEVEL_MIN);
+    CHECK_EQ(TxPower_Level(0x81u, 1u), TXPOWER_LEVEL_MAX);
+    CHECK_EQ(TxPower_Level(0x01u, 1u), TXPOWER_LEVEL_MIN);
+    CHECK_EQ(TxPower_Level(0x80u, 0u), TXPOWER_LEVEL_0DBM);
+    CHECK_EQ(TxPower_Level(0xFFu, 0u), TXPOWER_LEVEL_MAX);  // Out of range clamps
+    CHECK_EQ(TxPower_Level(0xF2u, 1u), TXPOWER_LEVEL_MAX);
+    
+    /* dBm per level, out of range levels clamp */
+    CHECK(TxPower_Dbm(TXPOWER_LEVEL_MIN) == -18);
+    CHECK_EQ(TxPower_Dbm(TXPOWER_LEVEL_0DBM), 0u);
+    CHECK_EQ(TxPower_Dbm(TXPOWER_LEVEL_MAX), 3u);
+    CHECK(TxPower_Dbm(0u) == -18);
+    CHECK_EQ(TxPower_Dbm(15u), 3u);
+    
+    /* Receivers get the level back from the advertised power */
+    for(level = TXPOWER_LEVEL_MIN; level <= TXPOWER_LEVEL_MAX; level++){
+        CHECK_EQ(TxPower_LevelOf(TxPower_Dbm(level)), level);
+        if(level > TXPOWER_LEVEL_MIN) CHECK(TxPower_Dbm(level) > TxPower_Dbm((uint8)(level - 1u)));
+    }
+    CHECK_EQ(TxPower_LevelOf(-40), TXPOWER_LEVEL_MIN);
+    CHECK_EQ(TxPower_LevelOf(-7), 2u);          // -12dBm, highest not above
+    CHECK_EQ(TxPower_LevelOf(2), TXPOWER_LEVEL_0DBM);
+    CHECK_EQ(TxPower_LevelOf(20), TXPOWER_LEVEL_MAX);
+    
+    /* Radio load: 1000 at 0dBm, only the TX share follows the current */
+    CHECK_EQ(TxPower_RadioPermille(TXPOWER_LEVEL_0DBM), 1000u);
+    CHECK_EQ(TxPower_RadioPermille(TXPOWER_LEVEL_MIN), 1000u - TXPOWER_TX_SHARE + ((TXPOWER_TX_SHARE * 3400u) / 5600u));
+    CHECK_EQ(TxPower_RadioPermille(TXPOWER_LEVEL_MAX), 1000u - TXPOWER_TX_SHARE + ((TXPOWER_TX_SHARE * 6700u) / 5600u));
+    for(level = TXPOWER_LEVEL_MIN; level < TXPOWER_LEVEL_MAX; level++){
+        CHECK(TxPower_CurrentUA(level) < TxPower_CurrentUA((uint8)(level + 1u)));
+        CHECK(TxPower_RadioPermille(level) < TxPower_RadioPermille((uint8)(level + 1u)));
+        CHECK(TxPower_RadioPermille(level) > (1000u - TXPOWER_TX_SHARE));
+    }
+    
+    return CHECK_DONE();
+}
+
+/* [] END OF FILE */